@@ -36,6 +36,12 @@ class TypeSupport
 public:
   size_t getEstimatedSerializedSize(const void * ros_message);
 
+  // Whether no message of this type can be serialized into more than getMaxSerializedSize() bytes
+  bool isBounded() const;
+
+  // Only a lower bound if the type isn't bounded
+  size_t getMaxSerializedSize() const;
+
   bool serializeROSmessage(
     const void * ros_message,
     eprosima::fastcdr::Cdr & ser,
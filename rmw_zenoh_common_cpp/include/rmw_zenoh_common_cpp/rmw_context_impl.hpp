@@ -16,6 +16,20 @@
 #define RMW_ZENOH_COMMON_CPP__RMW_CONTEXT_IMPL_HPP_
 
 #ifdef __cplusplus
+namespace rmw_zenoh_common_cpp
+{
+class BatchFlusher;
+class BufferPool;
+class GraphCache;
+
+template<typename EntityT>
+class DispatchTable;
+}  // namespace rmw_zenoh_common_cpp
+
+struct rmw_subscription_data_t;
+struct rmw_service_data_t;
+struct rmw_client_data_t;
+
 extern "C"
 {
 #endif
@@ -29,6 +43,23 @@ struct rmw_context_impl_t
 {
   zn_session_t * session;
   bool is_shutdown;
+
+  // Route the samples received by this session to its subscriptions, services and clients
+  rmw_zenoh_common_cpp::DispatchTable<rmw_subscription_data_t> * subscription_dispatch_table;
+  rmw_zenoh_common_cpp::DispatchTable<rmw_service_data_t> * service_dispatch_table;
+  rmw_zenoh_common_cpp::DispatchTable<rmw_client_data_t> * client_dispatch_table;
+
+  // Recycles the message buffers of the entities of this context
+  rmw_zenoh_common_cpp::BufferPool * buffer_pool;
+
+  // First bytes of the GIDs of the entities of this context (the ID of its Zenoh session)
+  uint8_t gid_prefix[8];
+
+  // Flushes the batch frames of the publishers of this context (null if batching is disabled)
+  rmw_zenoh_common_cpp::BatchFlusher * batch_flusher;
+
+  // Entities of the ROS graph, discovered in the background
+  rmw_zenoh_common_cpp::GraphCache * graph_cache;
 };
 
 #ifdef __cplusplus
@@ -15,10 +15,22 @@
 #ifndef RMW_ZENOH_COMMON_CPP__RMW_INIT_OPTIONS_IMPL_HPP_
 #define RMW_ZENOH_COMMON_CPP__RMW_INIT_OPTIONS_IMPL_HPP_
 
+#include <stddef.h>
+
 struct rmw_init_options_impl_t
 {
   char * session_locator;  // Zenoh session TCP locator
   char * mode;  // Zenoh session mode
+
+  size_t publish_batch_size;  // Max bytes of a publisher batch frame (0 disables batching)
+  size_t publish_batch_period_us;  // Max time a message waits in a batch frame
+
+  bool load_balance_requests;  // Send each request to one service server, round-robin
+  size_t request_timeout_ms;  // Responses to requests older than this are dropped (0 never)
+
+  size_t graph_event_window_ms;  // Graph changes within this window trigger graph guards once
+
+  bool loan_messages;  // Let publishers and subscriptions of bounded types loan messages
 };
 
 #endif  // RMW_ZENOH_COMMON_CPP__RMW_INIT_OPTIONS_IMPL_HPP_
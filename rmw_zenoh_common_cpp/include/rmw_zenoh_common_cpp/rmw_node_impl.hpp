@@ -21,6 +21,9 @@
 struct rmw_node_impl_t
 {
   rmw_guard_condition_t * graph_guard_condition_;
+
+  // Identifies the node in the graph of its context
+  uint8_t gid_[16];
 };
 
 #endif  // RMW_ZENOH_COMMON_CPP__RMW_NODE_IMPL_HPP_
@@ -27,6 +27,9 @@ rmw_zenoh_common_init_pre(
   const rmw_init_options_t * options, rmw_context_t * context,
   const char * const eclipse_zenoh_identifier);
 
+rmw_ret_t
+rmw_zenoh_common_init_post(rmw_context_t * context, const char * const eclipse_zenoh_identifier);
+
 rmw_node_t *
 rmw_zenoh_common_create_node(
   rmw_context_t * context,
@@ -131,6 +134,33 @@ rmw_zenoh_common_publish(
   rmw_publisher_allocation_t * allocation,
   const char * const eclipse_zenoh_identifier);
 
+rmw_ret_t
+rmw_zenoh_common_publish_serialized_message(
+  const rmw_publisher_t * publisher,
+  const rmw_serialized_message_t * serialized_message,
+  rmw_publisher_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier);
+
+rmw_ret_t
+rmw_zenoh_common_publish_loaned_message(
+  const rmw_publisher_t * publisher,
+  void * ros_message,
+  rmw_publisher_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier);
+
+rmw_ret_t
+rmw_zenoh_common_borrow_loaned_message(
+  const rmw_publisher_t * publisher,
+  const rosidl_message_type_support_t * type_support,
+  void ** ros_message,
+  const char * const eclipse_zenoh_identifier);
+
+rmw_ret_t
+rmw_zenoh_common_return_loaned_message_from_publisher(
+  const rmw_publisher_t * publisher,
+  void * loaned_message,
+  const char * const eclipse_zenoh_identifier);
+
 rmw_ret_t
 rmw_zenoh_common_take(
   const rmw_subscription_t * subscription,
@@ -155,13 +185,49 @@ rmw_zenoh_common_take_with_info(
   rmw_subscription_allocation_t * allocation,
   const char * const eclipse_zenoh_identifier);
 
+rmw_ret_t
+rmw_zenoh_common_take_sequence(
+  const rmw_subscription_t * subscription,
+  size_t count,
+  rmw_message_sequence_t * message_sequence,
+  rmw_message_info_sequence_t * message_info_sequence,
+  size_t * taken,
+  rmw_subscription_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier);
+
+rmw_ret_t
+rmw_zenoh_common_take_serialized_message(
+  const rmw_subscription_t * subscription,
+  rmw_serialized_message_t * serialized_message,
+  bool * taken,
+  rmw_subscription_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier);
+
+rmw_ret_t
+rmw_zenoh_common_take_serialized_message_with_info(
+  const rmw_subscription_t * subscription,
+  rmw_serialized_message_t * serialized_message,
+  bool * taken,
+  rmw_message_info_t * message_info,
+  rmw_subscription_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier);
+
+rmw_ret_t
+rmw_zenoh_common_take_loaned_message(
+  const rmw_subscription_t * subscription,
+  void ** loaned_message,
+  bool * taken,
+  rmw_subscription_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier);
+
 rmw_ret_t
 rmw_zenoh_common_take_loaned_message_with_info(
   const rmw_subscription_t * subscription,
   void ** loaned_message,
   bool * taken,
   rmw_message_info_t * message_info,
-  rmw_subscription_allocation_t * allocation);
+  rmw_subscription_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier);
 
 rmw_client_t *
 rmw_zenoh_common_create_client(
@@ -192,6 +258,13 @@ rmw_zenoh_common_get_gid_for_publisher(
   rmw_gid_t * gid,
   const char * const eclipse_zenoh_identifier);
 
+rmw_ret_t
+rmw_zenoh_common_compare_gids_equal(
+  const rmw_gid_t * gid1,
+  const rmw_gid_t * gid2,
+  bool * result,
+  const char * const eclipse_zenoh_identifier);
+
 rmw_ret_t
 rmw_zenoh_common_destroy_wait_set(
   rmw_wait_set_t * wait_set,
@@ -252,7 +325,8 @@ rmw_zenoh_common_destroy_client(
 rmw_ret_t
 rmw_zenoh_common_return_loaned_message_from_subscription(
   const rmw_subscription_t * subscription,
-  void * loaned_message);
+  void * loaned_message,
+  const char * const eclipse_zenoh_identifier);
 
 #ifdef __cplusplus
 }
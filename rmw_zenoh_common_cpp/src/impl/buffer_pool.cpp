@@ -0,0 +1,124 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "buffer_pool.hpp"
+
+#include <algorithm>
+#include <new>
+
+#include "rcutils/logging_macros.h"
+
+namespace rmw_zenoh_common_cpp
+{
+
+constexpr size_t BufferPool::kSmallestClassShift;
+constexpr size_t BufferPool::kClassCount;
+constexpr size_t BufferPool::kFreeBytesPerClass;
+constexpr size_t BufferPool::kMinFreeBuffers;
+constexpr size_t BufferPool::kMaxFreeBuffers;
+
+BufferPool::BufferPool(const rcutils_allocator_t & allocator)
+: allocator_(allocator), hits_(0), misses_(0)
+{
+  for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+    size_t capacity = static_cast<size_t>(1) << (kSmallestClassShift + size_class);
+    size_t free_buffers = std::min(
+      kMaxFreeBuffers, std::max(kMinFreeBuffers, kFreeBytesPerClass / capacity));
+
+    free_lists_[size_class].reset(new RingBuffer<MessageBuffer *>(free_buffers));
+  }
+}
+
+BufferPool::~BufferPool()
+{
+  RCUTILS_LOG_DEBUG_NAMED(
+    "rmw_zenoh_common_cpp",
+    "[buffer_pool] %zu hits, %zu misses",
+    hits(),
+    misses());
+
+  // Only the free buffers are deallocated. The entities (and so their queues) are all
+  // destroyed before their context is finalized, so no buffer should be in use anymore.
+  for (auto & free_list : free_lists_) {
+    MessageBuffer * buffer = nullptr;
+    while (free_list->try_pop(buffer)) {
+      deallocate(buffer);
+    }
+  }
+}
+
+MessageBufferPtr
+BufferPool::acquire(size_t size)
+{
+  // Find the smallest size class that fits
+  size_t size_class = 0;
+  size_t capacity = static_cast<size_t>(1) << kSmallestClassShift;
+  while (capacity < size && size_class < kClassCount) {
+    capacity <<= 1;
+    ++size_class;
+  }
+
+  MessageBuffer * buffer = nullptr;
+
+  if (size_class < kClassCount && free_lists_[size_class]->try_pop(buffer)) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+
+    // Too big for the biggest size class: allocate the exact size, never pooled
+    if (size_class == kClassCount) {
+      capacity = size;
+    }
+
+    buffer = allocate(size_class, capacity);
+    if (!buffer) {
+      return MessageBufferPtr();
+    }
+  }
+
+  buffer->set_size(size);
+  return MessageBufferPtr(buffer);
+}
+
+void
+BufferPool::release(MessageBuffer * buffer)
+{
+  if (buffer->size_class_ < kClassCount && free_lists_[buffer->size_class_]->try_push(
+      std::move(buffer)))
+  {
+    return;
+  }
+
+  // The free list is full (or the buffer isn't pooled)
+  deallocate(buffer);
+}
+
+MessageBuffer *
+BufferPool::allocate(size_t size_class, size_t capacity)
+{
+  void * memory = allocator_.allocate(sizeof(MessageBuffer) + capacity, allocator_.state);
+  if (!memory) {
+    return nullptr;
+  }
+  return new(memory) MessageBuffer(this, size_class, capacity);
+}
+
+void
+BufferPool::deallocate(MessageBuffer * buffer)
+{
+  buffer->~MessageBuffer();
+  allocator_.deallocate(buffer, allocator_.state);
+}
+
+}  // namespace rmw_zenoh_common_cpp
@@ -0,0 +1,233 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPL__BUFFER_POOL_HPP_
+#define IMPL__BUFFER_POOL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "rcutils/allocator.h"
+
+#include "ring_buffer.hpp"
+
+namespace rmw_zenoh_common_cpp
+{
+
+class BufferPool;
+class MessageBufferPtr;
+
+// Byte buffer handed out by a BufferPool
+//
+// The bytes are stored right after the buffer header, in the same allocation.
+class alignas(std::max_align_t) MessageBuffer
+{
+public:
+  unsigned char *
+  data()
+  {
+    return reinterpret_cast<unsigned char *>(this + 1);
+  }
+
+  const unsigned char *
+  data() const
+  {
+    return reinterpret_cast<const unsigned char *>(this + 1);
+  }
+
+  // Number of bytes in use
+  size_t
+  size() const
+  {
+    return size_;
+  }
+
+  // Must not be more than the capacity
+  void
+  set_size(size_t size)
+  {
+    size_ = size;
+  }
+
+  size_t
+  capacity() const
+  {
+    return capacity_;
+  }
+
+private:
+  friend class BufferPool;
+  friend class MessageBufferPtr;
+
+  MessageBuffer(BufferPool * pool, size_t size_class, size_t capacity)
+  : pool_(pool), size_class_(size_class), capacity_(capacity), size_(0), references_(0) {}
+
+  BufferPool * const pool_;
+  const size_t size_class_;
+  const size_t capacity_;
+  size_t size_;
+
+  std::atomic<uint32_t> references_;
+};
+
+// Reference counted handle to a MessageBuffer, which returns the buffer to its pool once the last
+// handle to it is gone
+//
+// This is how a received message is shared by the queues of all the subscriptions, services or
+// clients of its key without further copies. The count is kept in the buffer itself, so this
+// doesn't need a control block like std::shared_ptr does.
+class MessageBufferPtr
+{
+public:
+  MessageBufferPtr()
+  : buffer_(nullptr) {}
+
+  MessageBufferPtr(const MessageBufferPtr & other)
+  : buffer_(other.buffer_)
+  {
+    if (buffer_) {
+      buffer_->references_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  MessageBufferPtr(MessageBufferPtr && other) noexcept
+  : buffer_(other.buffer_)
+  {
+    other.buffer_ = nullptr;
+  }
+
+  MessageBufferPtr &
+  operator=(MessageBufferPtr other) noexcept
+  {
+    std::swap(buffer_, other.buffer_);
+    return *this;
+  }
+
+  ~MessageBufferPtr()
+  {
+    reset();
+  }
+
+  inline void reset();
+
+  MessageBuffer *
+  get() const
+  {
+    return buffer_;
+  }
+
+  MessageBuffer *
+  operator->() const
+  {
+    return buffer_;
+  }
+
+  explicit operator bool() const
+  {
+    return buffer_ != nullptr;
+  }
+
+  // Whether this is the only handle to the buffer, so that it can be written to again
+  bool
+  unique() const
+  {
+    return buffer_ && buffer_->references_.load(std::memory_order_acquire) == 1;
+  }
+
+private:
+  friend class BufferPool;
+
+  explicit MessageBufferPtr(MessageBuffer * buffer)
+  : buffer_(buffer)
+  {
+    buffer_->references_.store(1, std::memory_order_relaxed);
+  }
+
+  MessageBuffer * buffer_;
+};
+
+// Size-classed pool of message buffers, shared by all the entities of a context
+//
+// Buffer capacities are powers of two. Each size class keeps its released buffers in a lock-free
+// free list of bounded length, so acquiring and releasing buffers never takes a lock, and once the
+// free lists are warm, receiving, taking, and sending messages doesn't allocate memory anymore.
+// Buffers larger than the biggest size class are allocated and deallocated every time.
+class BufferPool
+{
+public:
+  explicit BufferPool(const rcutils_allocator_t & allocator);
+  ~BufferPool();
+
+  BufferPool(const BufferPool &) = delete;
+  BufferPool & operator=(const BufferPool &) = delete;
+
+  // Get a buffer that can hold at least size bytes, with its size set to size
+  //
+  // Returns a null handle if a new buffer had to be allocated, and that failed.
+  MessageBufferPtr acquire(size_t size);
+
+  // Number of acquisitions served from a free list
+  size_t
+  hits() const
+  {
+    return hits_.load(std::memory_order_relaxed);
+  }
+
+  // Number of acquisitions that had to allocate a new buffer
+  size_t
+  misses() const
+  {
+    return misses_.load(std::memory_order_relaxed);
+  }
+
+private:
+  friend class MessageBufferPtr;
+
+  // Smallest size class is 256 bytes, biggest is 4 MiB
+  static constexpr size_t kSmallestClassShift = 8;
+  static constexpr size_t kClassCount = 15;
+
+  // Bound on the bytes kept in each free list (with at least kMinFreeBuffers in each)
+  static constexpr size_t kFreeBytesPerClass = 4 * 1024 * 1024;
+  static constexpr size_t kMinFreeBuffers = 2;
+  static constexpr size_t kMaxFreeBuffers = 256;
+
+  // Called when the last handle to a buffer is gone
+  void release(MessageBuffer * buffer);
+
+  MessageBuffer * allocate(size_t size_class, size_t capacity);
+  void deallocate(MessageBuffer * buffer);
+
+  rcutils_allocator_t allocator_;
+  std::unique_ptr<RingBuffer<MessageBuffer *>> free_lists_[kClassCount];
+
+  std::atomic<size_t> hits_;
+  std::atomic<size_t> misses_;
+};
+
+void
+MessageBufferPtr::reset()
+{
+  if (buffer_ && buffer_->references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    buffer_->pool_->release(buffer_);
+  }
+  buffer_ = nullptr;
+}
+
+}  // namespace rmw_zenoh_common_cpp
+
+#endif  // IMPL__BUFFER_POOL_HPP_
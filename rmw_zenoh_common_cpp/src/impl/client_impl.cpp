@@ -14,6 +14,7 @@
 
 #include "client_impl.hpp"
 
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -23,91 +24,104 @@
 
 #include "rcutils/logging_macros.h"
 
-std::mutex response_callback_mutex;
-std::mutex query_callback_mutex;
+#include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
+
+#include "buffer_pool.hpp"
+#include "dispatch_table.hpp"
+#include "graph_cache.hpp"
 
 /// STATIC CLIENT DATA MEMBERS ================================================
 std::atomic<std::int64_t> rmw_client_data_t::sequence_id_counter(0);
 std::atomic<size_t> rmw_client_data_t::client_id_counter(0);
 
-// *INDENT-OFF* because uncrustify can't decide which way to format this
-// Map of Zenoh topic key expression to client data
-std::unordered_map<std::string, std::vector<rmw_client_data_t *>>
-  rmw_client_data_t::zn_topic_to_client_data;
-// *INDENT-ON*
-
-// *INDENT-OFF* because uncrustify can't decide which way to format this
-// Map of Zenoh queryable key expression to client data
-std::unordered_map<std::string, std::vector<rmw_client_data_t *>>
-  rmw_client_data_t::zn_queryable_to_client_data;
-// *INDENT-ON*
-
 /// ZENOH RESPONSE SUBSCRIPTION CALLBACK (static method) =======================
-void rmw_client_data_t::zn_response_sub_callback(const zn_sample_t * sample, const void *)
+// The callback argument is the fan-out of the Zenoh key expression the subscriber was declared for
+void rmw_client_data_t::zn_response_sub_callback(const zn_sample_t * sample, const void * arg)
 {
-  std::lock_guard<std::mutex> guard(response_callback_mutex);
-
-  // NOTE(CH3): We unfortunately have to do this copy construction since we shouldn't be using
-  // char * as keys to the unordered_map
-  std::string key(sample->key.val, sample->key.len);
-
-  // Vector to store the byte array (so we have a copyable container instead of a pointer)
-  std::vector<unsigned char> byte_vec(sample->value.val, sample->value.val + sample->value.len);
-
-  // Get shared pointer to byte array vector
-  // NOTE(CH3): We use a shared pointer to avoid copies and to leverage on the smart pointer's
-  // reference counting
-  auto byte_vec_ptr = std::make_shared<std::vector<unsigned char>>(std::move(byte_vec));
-
-  auto map_iter = rmw_client_data_t::zn_topic_to_client_data.find(key);
+  auto fanout = static_cast<const rmw_zenoh_common_cpp::TopicFanout<rmw_client_data_t> *>(arg);
+
+  // Message bytes, copied into a pooled buffer for the first client they are delivered to
+  rmw_zenoh_common_cpp::MessageBufferPtr msg_bytes;
+
+  // Responses end with the sequence ID of their request
+  if (sample->value.len < sizeof(std::int64_t)) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_zenoh_common_cpp",
+      "Discarding malformed response for client for %.*s",
+      static_cast<int>(sample->key.len),
+      sample->key.val);
+    return;
+  }
+  std::int64_t sequence_id;
+  std::memcpy(
+    &sequence_id,
+    sample->value.val + sample->value.len - sizeof(std::int64_t),
+    sizeof(std::int64_t));
 
-  // If the key was not found in the map, it means that there are no RMW clients listening on this
+  // If the fan-out has no client left, it means that there are no RMW clients listening on this
   // topic, so this message can be dropped without issue
-  if (map_iter != rmw_client_data_t::zn_topic_to_client_data.end()) {
-    // Push shared pointer to message bytes to all associated client response message queues
-    for (auto it = map_iter->second.begin(); it != map_iter->second.end(); ++it) {
-      std::unique_lock<std::mutex> lock((*it)->response_queue_mutex_);
-
-      if ((*it)->zn_response_message_queue_.size() >= (*it)->queue_depth_) {
-        // Log warning if message is discarded due to hitting the queue depth
-        RCUTILS_LOG_WARN_NAMED(
+  fanout->dispatch(
+    [sample, sequence_id, &msg_bytes](rmw_client_data_t * client_data) {
+      // Drop responses to requests that timed out, were already responded to (e.g. by another
+      // service server), or weren't made by this client, before copying them
+      if (!client_data->pending_requests_.complete(sequence_id)) {
+        RCUTILS_LOG_DEBUG_NAMED(
           "rmw_zenoh_common_cpp",
-          "Request queue depth of %ld reached, discarding oldest response message "
-          "for client for %s (ID: %ld)",
-          (*it)->queue_depth_,
-          key.c_str(),
-          (*it)->client_id_);
-
-        (*it)->zn_response_message_queue_.pop_back();
+          "Discarding response to request %ld that isn't pending for client for %.*s (ID: %ld)",
+          sequence_id,
+          static_cast<int>(sample->key.len),
+          sample->key.val,
+          client_data->client_id_);
+        return;
       }
-      (*it)->zn_response_message_queue_.push_front(byte_vec_ptr);
 
-      (*it)->response_queue_mutex_.unlock();
-    }
-  }
-}
-/// ZENOH SERVICE AVAILABILITY QUERY CALLBACK ==================================
-void rmw_client_data_t::zn_service_availability_query_callback(
-  const zn_source_info_t *,
-  const zn_sample_t * sample,
-  const void *)
-{
-  std::lock_guard<std::mutex> guard(query_callback_mutex);
-
-  // NOTE(CH3): We unfortunately have to do this copy construction since we shouldn't be using
-  // char * as keys to the unordered_map
-  std::string key(sample->key.val, sample->key.len);
-
-  auto map_iter = rmw_client_data_t::zn_queryable_to_client_data.find(key);
+      if (!msg_bytes) {
+        auto buffer_pool = client_data->node_->context->impl->buffer_pool;
+        msg_bytes = buffer_pool->acquire(sample->value.len);
+        if (!msg_bytes) {
+          RCUTILS_LOG_ERROR_NAMED(
+            "rmw_zenoh_common_cpp",
+            "Failed to allocate buffer, discarding response for client for %.*s",
+            static_cast<int>(sample->key.len),
+            sample->key.val);
+          return;
+        }
+        std::memcpy(msg_bytes->data(), sample->value.val, sample->value.len);
+      }
 
-  if (map_iter != rmw_client_data_t::zn_queryable_to_client_data.end()) {
-    // Update all associated client availability query response sets
-    for (auto it = map_iter->second.begin(); it != map_iter->second.end(); ++it) {
-      std::unique_lock<std::mutex> lock((*it)->availability_set_mutex_);
+      // Push message buffer to the client response message queue
+      // If it is full, pop the oldest response to make room for it and try again
+      // (rmw_take_response() or another Zenoh thread may get to the freed slot first)
+      rmw_zenoh_common_cpp::MessageBufferPtr entry = msg_bytes;
+      while (!client_data->zn_response_message_queue_->try_push(std::move(entry))) {
+        rmw_zenoh_common_cpp::MessageBufferPtr oldest;
+        if (client_data->zn_response_message_queue_->try_pop(oldest)) {
+          // Log warning if message is discarded due to hitting the queue depth
+          RCUTILS_LOG_WARN_NAMED(
+            "rmw_zenoh_common_cpp",
+            "Response queue depth of %ld reached, discarding oldest response message "
+            "for client for %.*s (ID: %ld)",
+            client_data->queue_depth_,
+            static_cast<int>(sample->key.len),
+            sample->key.val,
+            client_data->client_id_);
+        }
+      }
 
-      (*it)->zn_availability_query_responses_.insert(key);
+      client_data->condition_listener_.notify();
+    });
+}
 
-      (*it)->availability_set_mutex_.unlock();
-    }
+/// LOAD BALANCING =============================================================
+bool rmw_client_data_t::next_server(const std::string & service_name, uint8_t * gid)
+{
+  std::vector<std::string> server_gids;
+  node_->context->impl->graph_cache->get_service_gids(service_name, server_gids);
+  if (server_gids.empty()) {
+    return false;
   }
+
+  size_t server = next_server_.fetch_add(1, std::memory_order_relaxed) % server_gids.size();
+  std::memcpy(gid, server_gids[server].data(), rmw_zenoh_common_cpp::GID_SIZE);
+  return true;
 }
@@ -16,18 +16,21 @@
 #define IMPL__CLIENT_IMPL_HPP_
 
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <string>
 #include <vector>
 #include <memory>
-#include <deque>
-#include <mutex>
 #include <atomic>
 
 #include "rmw/rmw.h"
 #include "rmw_zenoh_common_cpp/TypeSupport.hpp"
 
+#include "buffer_pool.hpp"
+#include "condition_listener.hpp"
+#include "gid.hpp"
+#include "pending_requests.hpp"
+#include "ring_buffer.hpp"
+
 extern "C"
 {
 #include "rmw_zenoh_common_cpp/zenoh-net-interface.h"
@@ -37,9 +40,6 @@ struct rmw_client_data_t
 {
   /// STATIC MEMBERS ===========================================================
   static void zn_response_sub_callback(const zn_sample_t * sample, const void * arg);
-  static void zn_service_availability_query_callback(
-    const zn_source_info_t * info, const zn_sample_t * sample, const void * arg
-  );
 
   // Counter to give client servers unique IDs
   static std::atomic<size_t> client_id_counter;
@@ -47,17 +47,11 @@ struct rmw_client_data_t
   // Request-response sequence id (To identify and match individual requests)
   static std::atomic<std::int64_t> sequence_id_counter;
 
-  // *INDENT-OFF* because uncrustify can't decide which way to format this
-  // Map of Zenoh topic key expression to client data struct instances
-  static std::unordered_map<std::string, std::vector<rmw_client_data_t *>>
-    zn_topic_to_client_data;
-  // *INDENT-ON*
-
-  // *INDENT-OFF* because uncrustify can't decide which way to format this
-  // Map of Zenoh queryable key expression to client data struct instances
-  static std::unordered_map<std::string, std::vector<rmw_client_data_t *>>
-    zn_queryable_to_client_data;
-  // *INDENT-ON*
+  /// LOAD BALANCING ===========================================================
+  // Get the GID of the server to send the next request to, round-robin
+  //
+  // Returns false if no server of the service has been discovered.
+  bool next_server(const std::string & service_name, uint8_t * gid);
 
   /// TYPE SUPPORT =============================================================
   const void * request_type_support_impl_;
@@ -71,8 +65,9 @@ struct rmw_client_data_t
   zn_session_t * zn_session_;
 
   // Response Sub
+  // Each client has its own response key (<service>/response/<client GID>), so it only
+  // receives the responses to its own requests
   const char * zn_response_topic_key_;
-  zn_subscriber_t * zn_response_subscriber_;
 
   // Request Pub
   const char * zn_request_topic_key_;
@@ -81,13 +76,23 @@ struct rmw_client_data_t
   /// ROS ======================================================================
   const rmw_node_t * node_;
 
+  // Requests still waiting for their response, the responses to any other request are dropped
+  rmw_zenoh_common_cpp::PendingRequests pending_requests_;
+
   // Instanced response message queue
-  std::deque<std::shared_ptr<std::vector<unsigned char>>> zn_response_message_queue_;
-  std::mutex response_queue_mutex_;
+  // Holds at most queue_depth_ responses, the oldest response is dropped to make room for a new one
+  using ResponseQueue = rmw_zenoh_common_cpp::RingBuffer<rmw_zenoh_common_cpp::MessageBufferPtr>;
+  std::unique_ptr<ResponseQueue> zn_response_message_queue_;
+
+  // Index of the server that gets the next request, among the servers of the service
+  std::atomic<size_t> next_server_;
+  bool load_balance_;
+
+  // Wakes the wait set this client is attached to when a response arrives
+  ConditionListener condition_listener_;
 
-  // Instanced availability query Zenoh responses
-  std::unordered_set<std::string> zn_availability_query_responses_;
-  std::mutex availability_set_mutex_;
+  // Globally unique ID, sent along with requests so the service can address the response
+  uint8_t gid_[rmw_zenoh_common_cpp::GID_SIZE];
 
   size_t client_id_;
   size_t queue_depth_;
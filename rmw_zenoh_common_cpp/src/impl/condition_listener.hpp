@@ -0,0 +1,123 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPL__CONDITION_LISTENER_HPP_
+#define IMPL__CONDITION_LISTENER_HPP_
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+typedef struct rmw_wait_set_data_t
+{
+  std::condition_variable condition;
+  std::mutex condition_mutex;
+
+  // Set by rmw_wait() while it is blocked (or about to block) on the condition variable
+  std::atomic_bool waiting{false};
+
+  // Wake up rmw_wait() after the state it waits on has been changed
+  //
+  // The condition mutex is only taken if rmw_wait() is actually blocked, so notifying a wait set
+  // that is busy elsewhere costs a fence and an atomic load.
+  void
+  notify()
+  {
+    // Pairs with the fence in rmw_wait() between setting waiting and checking the wait conditions.
+    // Either rmw_wait() sees the new state, or we see that it's waiting.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (waiting.load(std::memory_order_relaxed)) {
+      // Taking the mutex orders this notification after any predicate check that is in progress,
+      // so the wakeup can't be lost
+      { std::lock_guard<std::mutex> lock(condition_mutex); }
+      condition.notify_one();
+    }
+  }
+} rmw_wait_set_data_t;
+
+// Wakes up the wait sets that are currently blocked on an entity (subscription, service, client or
+// guard condition)
+//
+// rmw_wait() attaches its wait set to every entity it waits on and detaches it before returning.
+// The Zenoh callbacks call notify() after enqueueing data for the entity. Several wait sets can
+// wait on the same entity, up to MAX_ATTACHED_WAIT_SETS of them.
+class ConditionListener
+{
+public:
+  static constexpr size_t MAX_ATTACHED_WAIT_SETS = 4;
+
+  ConditionListener()
+  : attached_(0)
+  {
+    waitSets_.fill(nullptr);
+  }
+
+  // Returns false if too many wait sets are already attached, in which case this one won't be
+  // notified (and must not block on the entity without a timeout)
+  bool
+  attachCondition(rmw_wait_set_data_t * waitSet)
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    for (auto & attached : waitSets_) {
+      if (attached == nullptr) {
+        attached = waitSet;
+        attached_.fetch_add(1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Once this returns, the wait set isn't being notified and won't be anymore
+  void
+  detachCondition(rmw_wait_set_data_t * waitSet)
+  {
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    for (auto & attached : waitSets_) {
+      if (attached == waitSet) {
+        attached = nullptr;
+        attached_.fetch_sub(1);
+        return;
+      }
+    }
+  }
+
+  void
+  notify()
+  {
+    // Skip the mutex when no wait set is attached. Pairs with attachCondition() being ordered
+    // before rmw_wait() checks the entity: either rmw_wait() sees the new state, or we see it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (attached_.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(internalMutex_);
+    for (rmw_wait_set_data_t * waitSet : waitSets_) {
+      if (waitSet != nullptr) {
+        waitSet->notify();
+      }
+    }
+  }
+
+private:
+  std::mutex internalMutex_;
+  std::array<rmw_wait_set_data_t *, MAX_ATTACHED_WAIT_SETS> waitSets_;
+  std::atomic<size_t> attached_;
+};
+
+#endif  // IMPL__CONDITION_LISTENER_HPP_
@@ -0,0 +1,208 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPL__DISPATCH_TABLE_HPP_
+#define IMPL__DISPATCH_TABLE_HPP_
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+extern "C"
+{
+#include "rmw_zenoh_common_cpp/zenoh-net-interface.h"
+}
+
+namespace rmw_zenoh_common_cpp
+{
+
+template<typename EntityT>
+class DispatchTable;
+
+// Delivers the samples received on one Zenoh key expression to the local entities listening on it
+//
+// The fan-out is the callback argument of the Zenoh subscriber declared for its key, so callbacks
+// reach the entities with a pointer dereference, without building or hashing the key.
+template<typename EntityT>
+class TopicFanout
+{
+public:
+  explicit TopicFanout(const std::string & key)
+  : key_(key), subscriber_(nullptr) {}
+
+  // Call deliver(entity) for every entity listening on the key
+  //
+  // Returns the number of entities that the sample was delivered to.
+  template<typename FunctorT>
+  size_t
+  dispatch(FunctorT && deliver) const
+  {
+    // Only contends with adding and removing entities on this key
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    for (EntityT * entity : entities_) {
+      deliver(entity);
+    }
+    return entities_.size();
+  }
+
+  // Number of entities listening on the key
+  size_t
+  size() const
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    return entities_.size();
+  }
+
+  const std::string &
+  key() const
+  {
+    return key_;
+  }
+
+private:
+  friend class DispatchTable<EntityT>;
+
+  mutable std::shared_timed_mutex mutex_;
+  std::vector<EntityT *> entities_;
+
+  const std::string key_;
+
+  // Only touched by the owning DispatchTable, under its mutex
+  zn_subscriber_t * subscriber_;
+};
+
+// Owns the fan-outs of a context for one entity type, and the single Zenoh subscriber that is
+// declared per key expression, no matter how many entities listen on it
+//
+// The table is only used when entities are created and destroyed, never on the receive path.
+template<typename EntityT>
+class DispatchTable
+{
+public:
+  using CallbackT = void (*)(const zn_sample_t *, const void *);
+
+  explicit DispatchTable(CallbackT callback)
+  : callback_(callback) {}
+
+  // Start delivering samples on key to entity, declaring the Zenoh subscriber for key if this is
+  // the first entity listening on it
+  //
+  // Returns false if the Zenoh subscriber could not be declared.
+  bool
+  add(zn_session_t * session, const std::string & key, EntityT * entity)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::shared_ptr<TopicFanout<EntityT>> & fanout = fanouts_[key];
+    if (!fanout) {
+      fanout = std::make_shared<TopicFanout<EntityT>>(key);
+    }
+
+    {
+      std::unique_lock<std::shared_timed_mutex> fanout_lock(fanout->mutex_);
+      fanout->entities_.push_back(entity);
+    }
+
+    if (fanout->subscriber_) {
+      return true;
+    }
+
+    // We declare subscribers ONCE per key (otherwise we'll get duplicate messages)
+    fanout->subscriber_ = zn_declare_subscriber(
+      session, zn_rname(key.c_str()), zn_subinfo_default(), callback_, fanout.get());
+
+    if (!fanout->subscriber_) {
+      std::unique_lock<std::shared_timed_mutex> fanout_lock(fanout->mutex_);
+      fanout->entities_.pop_back();
+      return false;
+    }
+
+    return true;
+  }
+
+  // Get the fan-out of key, even if no entity listens on it (yet)
+  //
+  // This lets the local publishers of the context deliver to the entities listening on key
+  // directly. Fan-outs live as long as the table, so the pointer can be kept until then.
+  const TopicFanout<EntityT> *
+  get_fanout(const std::string & key)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::shared_ptr<TopicFanout<EntityT>> & fanout = fanouts_[key];
+    if (!fanout) {
+      fanout = std::make_shared<TopicFanout<EntityT>>(key);
+    }
+    return fanout.get();
+  }
+
+  // Stop delivering samples on key to entity, undeclaring the Zenoh subscriber for key if this
+  // was the last entity listening on it
+  //
+  // Once this returns, no callback is delivering to entity anymore, so it can be deallocated.
+  // Returns false if entity wasn't listening on key.
+  bool
+  remove(const std::string & key, EntityT * entity)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto map_iter = fanouts_.find(key);
+    if (map_iter == fanouts_.end()) {
+      return false;
+    }
+    TopicFanout<EntityT> * fanout = map_iter->second.get();
+
+    {
+      // Waits for the callbacks that are delivering to the entities of this key
+      std::unique_lock<std::shared_timed_mutex> fanout_lock(fanout->mutex_);
+
+      auto it = std::find(fanout->entities_.begin(), fanout->entities_.end(), entity);
+      if (it == fanout->entities_.end()) {
+        return false;
+      }
+      fanout->entities_.erase(it);
+
+      if (!fanout->entities_.empty()) {
+        return true;
+      }
+    }
+
+    // The fan-out itself is kept until the table is destroyed with its context (after
+    // the session is closed). Zenoh may still be running a callback for the subscriber after it is
+    // undeclared, and the fan-out is reused if an entity listens on the key again.
+    if (fanout->subscriber_) {
+      zn_undeclare_subscriber(fanout->subscriber_);
+      fanout->subscriber_ = nullptr;
+    }
+
+    return true;
+  }
+
+private:
+  CallbackT callback_;
+
+  // Serializes adding and removing entities (but not dispatching)
+  std::mutex mutex_;
+
+  std::unordered_map<std::string, std::shared_ptr<TopicFanout<EntityT>>> fanouts_;
+};
+
+}  // namespace rmw_zenoh_common_cpp
+
+#endif  // IMPL__DISPATCH_TABLE_HPP_
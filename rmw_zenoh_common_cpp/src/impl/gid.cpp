@@ -0,0 +1,116 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gid.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "rcutils/logging_macros.h"
+
+namespace rmw_zenoh_common_cpp
+{
+
+namespace
+{
+// Counter to give the entities of this process unique GIDs
+std::atomic<uint64_t> gid_counter(0);
+
+int
+hex_digit_value(char c)
+{
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+std::string
+to_hex(const uint8_t * bytes, size_t size)
+{
+  static const char digits[] = "0123456789abcdef";
+
+  std::string str(2 * size, '0');
+  for (size_t i = 0; i < size; ++i) {
+    str[2 * i] = digits[bytes[i] >> 4];
+    str[2 * i + 1] = digits[bytes[i] & 0xf];
+  }
+  return str;
+}
+}  // namespace
+
+void
+get_session_gid_prefix(zn_session_t * session, uint8_t prefix[GID_PREFIX_SIZE])
+{
+  // The session ID is given as a hex string
+  size_t parsed = 0;
+
+  zn_properties_t * info = zn_info(session);
+  if (info) {
+    z_string_t pid = zn_properties_get(info, ZN_INFO_PID_KEY);
+    for (; parsed < GID_PREFIX_SIZE && 2 * parsed + 1 < pid.len; ++parsed) {
+      int high = hex_digit_value(pid.val[2 * parsed]);
+      int low = hex_digit_value(pid.val[2 * parsed + 1]);
+      if (high < 0 || low < 0) {
+        break;
+      }
+      prefix[parsed] = static_cast<uint8_t>(high << 4 | low);
+    }
+    zn_properties_free(info);
+  }
+
+  if (parsed < GID_PREFIX_SIZE) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_zenoh_common_cpp",
+      "Could not obtain the Zenoh session ID, using a random GID prefix");
+
+    std::random_device random;
+    for (size_t i = 0; i < GID_PREFIX_SIZE; ++i) {
+      prefix[i] = static_cast<uint8_t>(random());
+    }
+  }
+}
+
+void
+generate_gid(const uint8_t prefix[GID_PREFIX_SIZE], uint8_t gid[GID_SIZE])
+{
+  uint64_t id = gid_counter.fetch_add(1, std::memory_order_relaxed);
+
+  std::memcpy(gid, prefix, GID_PREFIX_SIZE);
+  for (size_t i = 0; i < GID_SIZE - GID_PREFIX_SIZE; ++i) {
+    gid[GID_PREFIX_SIZE + i] = static_cast<uint8_t>(id >> (8 * i));
+  }
+}
+
+std::string
+gid_to_string(const uint8_t gid[GID_SIZE])
+{
+  return to_hex(gid, GID_SIZE);
+}
+
+std::string
+gid_prefix_to_string(const uint8_t prefix[GID_PREFIX_SIZE])
+{
+  return to_hex(prefix, GID_PREFIX_SIZE);
+}
+
+}  // namespace rmw_zenoh_common_cpp
@@ -0,0 +1,57 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPL__GID_HPP_
+#define IMPL__GID_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+extern "C"
+{
+#include "rmw_zenoh_common_cpp/zenoh-net-interface.h"
+}
+
+namespace rmw_zenoh_common_cpp
+{
+
+// Entity GIDs are globally unique: the first GID_PREFIX_SIZE bytes of the ID of the Zenoh session
+// of the entity, then a process-wide counter
+//
+// They fit in both rmw_gid_t and rmw_request_id_t::writer_guid.
+constexpr size_t GID_SIZE = 16;
+constexpr size_t GID_PREFIX_SIZE = 8;
+
+// Every sample written by a publisher (single message or batch frame) is followed by the GID of
+// the publisher, which subscriptions report in rmw_message_info_t::publisher_gid
+constexpr size_t PUBLISHER_GID_TRAILER_SIZE = GID_SIZE;
+
+// Get the GID prefix of the entities of a session
+//
+// Falls back to random bytes if the ID of the session can't be obtained.
+void get_session_gid_prefix(zn_session_t * session, uint8_t prefix[GID_PREFIX_SIZE]);
+
+// Generate a new GID with the given session prefix
+void generate_gid(const uint8_t prefix[GID_PREFIX_SIZE], uint8_t gid[GID_SIZE]);
+
+// Lowercase hex representation of a GID (e.g. to use it in a Zenoh key)
+std::string gid_to_string(const uint8_t gid[GID_SIZE]);
+
+// Lowercase hex representation of a GID prefix (which identifies a context)
+std::string gid_prefix_to_string(const uint8_t prefix[GID_PREFIX_SIZE]);
+
+}  // namespace rmw_zenoh_common_cpp
+
+#endif  // IMPL__GID_HPP_
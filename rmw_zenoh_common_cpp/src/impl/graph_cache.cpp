@@ -0,0 +1,840 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "graph_cache.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcutils/logging_macros.h"
+#include "rcutils/strdup.h"
+#include "rmw/error_handling.h"
+
+#include "graph_message.hpp"
+#include "guard_condition_impl.hpp"
+
+namespace rmw_zenoh_common_cpp
+{
+
+namespace
+{
+// Key space the contexts announce their entities on
+// ROS names can't contain '@', so this can't clash with the key of a topic or service
+const char GRAPH_KEY_PREFIX[] = "/@rmw_zenoh/graph";
+
+// Contexts publish a heartbeat this often
+constexpr std::chrono::seconds HEARTBEAT_PERIOD(1);
+
+// The entities of a context that hasn't been heard from for this long are removed
+constexpr std::chrono::seconds CONTEXT_LEASE(5);
+
+std::string
+gid_key(const uint8_t gid[GID_SIZE])
+{
+  return std::string(reinterpret_cast<const char *>(gid), GID_SIZE);
+}
+
+size_t
+count_gids(
+  const std::unordered_map<std::string, std::unordered_set<std::string>> & index,
+  const std::string & name)
+{
+  auto it = index.find(name);
+  return it == index.end() ? 0 : it->second.size();
+}
+
+void
+add_gid(
+  std::unordered_map<std::string, std::unordered_set<std::string>> & index,
+  const std::string & name,
+  const uint8_t gid[GID_SIZE])
+{
+  index[name].insert(gid_key(gid));
+}
+
+void
+remove_gid(
+  std::unordered_map<std::string, std::unordered_set<std::string>> & index,
+  const std::string & name,
+  const uint8_t gid[GID_SIZE])
+{
+  auto it = index.find(name);
+  if (it != index.end()) {
+    it->second.erase(gid_key(gid));
+    if (it->second.empty()) {
+      index.erase(it);
+    }
+  }
+}
+
+// The ID of the context that sent a sample is the last chunk of its key
+std::string
+sample_context_id(const zn_sample_t * sample)
+{
+  std::string key(sample->key.val, sample->key.len);
+  return key.substr(key.rfind('/') + 1);
+}
+
+void
+add_type(TypeCounts & type_counts, const std::string & name, const std::string & type)
+{
+  ++type_counts[name][type];
+}
+
+void
+remove_type(TypeCounts & type_counts, const std::string & name, const std::string & type)
+{
+  auto name_it = type_counts.find(name);
+  if (name_it == type_counts.end()) {
+    return;
+  }
+  auto type_it = name_it->second.find(type);
+  if (type_it != name_it->second.end() && --type_it->second == 0) {
+    name_it->second.erase(type_it);
+  }
+  if (name_it->second.empty()) {
+    type_counts.erase(name_it);
+  }
+}
+
+void
+copy_types(const TypeCounts & type_counts, NamesAndTypes & names_and_types)
+{
+  for (const auto & name : type_counts) {
+    std::set<std::string> & types = names_and_types[name.first];
+    for (const auto & type : name.second) {
+      types.insert(type.first);
+    }
+  }
+}
+}  // namespace
+
+/// NAMES AND TYPES ============================================================
+rmw_ret_t
+copy_names_and_types(
+  const NamesAndTypes & names_and_types,
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * rmw_names_and_types)
+{
+  rmw_ret_t ret = rmw_names_and_types_init(
+    rmw_names_and_types, names_and_types.size(), allocator);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+
+  size_t i = 0;
+  for (const auto & name : names_and_types) {
+    rmw_names_and_types->names.data[i] = rcutils_strdup(name.first.c_str(), *allocator);
+    if (!rmw_names_and_types->names.data[i]) {
+      RMW_SET_ERROR_MSG("failed to allocate name");
+      rmw_names_and_types_fini(rmw_names_and_types);
+      return RMW_RET_BAD_ALLOC;
+    }
+
+    rcutils_string_array_t & types = rmw_names_and_types->types[i];
+    if (rcutils_string_array_init(&types, name.second.size(), allocator) != RCUTILS_RET_OK) {
+      RMW_SET_ERROR_MSG("failed to allocate types");
+      rmw_names_and_types_fini(rmw_names_and_types);
+      return RMW_RET_BAD_ALLOC;
+    }
+
+    size_t j = 0;
+    for (const std::string & type : name.second) {
+      types.data[j] = rcutils_strdup(type.c_str(), *allocator);
+      if (!types.data[j]) {
+        RMW_SET_ERROR_MSG("failed to allocate type");
+        rmw_names_and_types_fini(rmw_names_and_types);
+        return RMW_RET_BAD_ALLOC;
+      }
+      ++j;
+    }
+    ++i;
+  }
+  return RMW_RET_OK;
+}
+
+/// GRAPH CACHE ================================================================
+GraphCache::GraphCache(
+  zn_session_t * session,
+  const uint8_t gid_prefix[GID_PREFIX_SIZE],
+  std::chrono::milliseconds event_window)
+: session_(session),
+  context_id_(gid_prefix_to_string(gid_prefix)),
+  key_(std::string(GRAPH_KEY_PREFIX) + "/" + context_id_),
+  key_id_(0),
+  subscriber_(nullptr),
+  queryable_(nullptr),
+  started_(false),
+  stopped_(false),
+  local_sequence_(0),
+  event_window_(event_window),
+  graph_changed_(false)
+{
+}
+
+GraphCache::~GraphCache()
+{
+  stop();
+}
+
+bool
+GraphCache::start()
+{
+  const std::string all_contexts_key = std::string(GRAPH_KEY_PREFIX) + "/*";
+
+  key_id_ = zn_declare_resource(session_, zn_rname(key_.c_str()));
+
+  subscriber_ = zn_declare_subscriber(
+    session_,
+    zn_rname(all_contexts_key.c_str()),
+    zn_subinfo_default(),
+    GraphCache::zn_graph_sub_callback,
+    this);
+  if (!subscriber_) {
+    return false;
+  }
+
+  queryable_ = zn_declare_queryable(
+    session_,
+    zn_rname(key_.c_str()),
+    ZN_QUERYABLE_STORAGE,
+    GraphCache::zn_graph_queryable_callback,
+    this);
+  if (!queryable_) {
+    zn_undeclare_subscriber(subscriber_);
+    subscriber_ = nullptr;
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    started_ = true;
+  }
+
+  // Catch up with the contexts that are already running
+  query(all_contexts_key);
+
+  thread_ = std::thread(&GraphCache::run, this);
+  return true;
+}
+
+void
+GraphCache::stop()
+{
+  {
+    std::lock_guard<std::mutex> publish_guard(publish_mutex_);
+
+    std::vector<uint8_t> goodbye;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      if (stopped_) {
+        return;
+      }
+      stopped_ = true;
+      if (!started_) {
+        return;
+      }
+
+      if (!local_entities_.empty()) {
+        GraphMessageWriter writer(++local_sequence_);
+        for (const auto & local_entity : local_entities_) {
+          writer.remove(local_entity.second.gid);
+        }
+        goodbye = std::move(writer.data());
+      }
+    }
+
+    // The other contexts remove the local entities right away, rather than once the lease expires
+    if (!goodbye.empty()) {
+      publish(goodbye);
+    }
+  }
+  condition_.notify_one();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  // Zenoh may still be running a callback after undeclaring, which is fine since the
+  // cache is only destroyed once the session is closed
+  zn_undeclare_queryable(queryable_);
+  zn_undeclare_subscriber(subscriber_);
+  queryable_ = nullptr;
+  subscriber_ = nullptr;
+}
+
+void
+GraphCache::add_local_entity(const EntityInfo & entity)
+{
+  std::lock_guard<std::mutex> publish_guard(publish_mutex_);
+
+  std::vector<uint8_t> delta;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!local_entities_.emplace(gid_key(entity.gid), entity).second) {
+      return;
+    }
+    index_entity(entity);
+    graph_changed_locked();
+
+    if (!started_ || stopped_) {
+      return;
+    }
+    GraphMessageWriter writer(++local_sequence_);
+    writer.add(entity);
+    delta = std::move(writer.data());
+  }
+  publish(delta);
+}
+
+void
+GraphCache::remove_local_entity(const uint8_t gid[GID_SIZE])
+{
+  std::lock_guard<std::mutex> publish_guard(publish_mutex_);
+
+  std::vector<uint8_t> delta;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = local_entities_.find(gid_key(gid));
+    if (it == local_entities_.end()) {
+      return;
+    }
+    unindex_entity(it->second);
+    local_entities_.erase(it);
+    graph_changed_locked();
+
+    if (!started_ || stopped_) {
+      return;
+    }
+    GraphMessageWriter writer(++local_sequence_);
+    writer.remove(gid);
+    delta = std::move(writer.data());
+  }
+  publish(delta);
+}
+
+size_t
+GraphCache::count_publishers(const std::string & topic_name) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return count_gids(publishers_, topic_name);
+}
+
+size_t
+GraphCache::count_subscriptions(const std::string & topic_name) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return count_gids(subscriptions_, topic_name);
+}
+
+size_t
+GraphCache::count_services(const std::string & service_name) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return count_gids(services_, service_name);
+}
+
+std::shared_ptr<const TopicEndpointCounts>
+GraphCache::get_topic_endpoint_counts(const std::string & topic_name)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  std::weak_ptr<TopicEndpointCounts> & entry = topic_endpoint_counts_[topic_name];
+  std::shared_ptr<TopicEndpointCounts> counts = entry.lock();
+  if (!counts) {
+    counts = std::make_shared<TopicEndpointCounts>();
+    counts->publishers.store(count_gids(publishers_, topic_name));
+    counts->subscriptions.store(count_gids(subscriptions_, topic_name));
+    entry = counts;
+  }
+  return counts;
+}
+
+void
+GraphCache::get_service_gids(
+  const std::string & service_name, std::vector<std::string> & gids) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = services_.find(service_name);
+  if (it != services_.end()) {
+    gids.insert(gids.end(), it->second.begin(), it->second.end());
+  }
+}
+
+void
+GraphCache::get_topic_names_and_types(NamesAndTypes & topic_names_and_types) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  copy_types(topic_types_, topic_names_and_types);
+}
+
+void
+GraphCache::get_service_names_and_types(NamesAndTypes & service_names_and_types) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  copy_types(service_types_, service_names_and_types);
+}
+
+void
+GraphCache::get_node_names(std::vector<NodeName> & node_names) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (const auto & node : nodes_) {
+    for (size_t i = 0; i < node.second.node_count; ++i) {
+      node_names.push_back({node.first.second, node.first.first, node.second.enclave});
+    }
+  }
+}
+
+bool
+GraphCache::get_node_names_and_types(
+  const std::string & node_name,
+  const std::string & node_namespace,
+  EntityKind kind,
+  NamesAndTypes & names_and_types) const
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  auto it = nodes_.find(std::make_pair(node_namespace, node_name));
+  if (it == nodes_.end() || it->second.node_count == 0) {
+    return false;
+  }
+
+  switch (kind) {
+    case EntityKind::PUBLISHER:
+      copy_types(it->second.publishers, names_and_types);
+      break;
+    case EntityKind::SUBSCRIPTION:
+      copy_types(it->second.subscriptions, names_and_types);
+      break;
+    case EntityKind::SERVICE:
+      copy_types(it->second.services, names_and_types);
+      break;
+    case EntityKind::CLIENT:
+      copy_types(it->second.clients, names_and_types);
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+void
+GraphCache::add_graph_guard_condition(GuardCondition * guard_condition)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  guard_conditions_.push_back(guard_condition);
+}
+
+void
+GraphCache::remove_graph_guard_condition(GuardCondition * guard_condition)
+{
+  // Guard conditions are only triggered under the mutex, so it can be destroyed after this
+  std::lock_guard<std::mutex> guard(mutex_);
+  guard_conditions_.erase(
+    std::remove(guard_conditions_.begin(), guard_conditions_.end(), guard_condition),
+    guard_conditions_.end());
+}
+
+/// ZENOH CALLBACKS ============================================================
+// Deltas and heartbeats of the other contexts
+void
+GraphCache::zn_graph_sub_callback(const zn_sample_t * sample, const void * arg)
+{
+  auto cache = static_cast<GraphCache *>(const_cast<void *>(arg));
+
+  std::string context_id = sample_context_id(sample);
+  if (context_id == cache->context_id_) {
+    return;
+  }
+  cache->handle_delta(context_id, sample->value.val, sample->value.len);
+}
+
+// Snapshot of the local entities, for another context
+void
+GraphCache::zn_graph_queryable_callback(zn_query_t * query, const void * arg)
+{
+  auto cache = static_cast<GraphCache *>(const_cast<void *>(arg));
+
+  std::vector<uint8_t> snapshot;
+  {
+    std::lock_guard<std::mutex> guard(cache->mutex_);
+    GraphMessageWriter writer(cache->local_sequence_);
+    for (const auto & local_entity : cache->local_entities_) {
+      writer.add(local_entity.second);
+    }
+    snapshot = std::move(writer.data());
+  }
+
+  zn_send_reply(query, cache->key_.c_str(), snapshot.data(), snapshot.size());
+}
+
+// Snapshots of the other contexts
+void
+GraphCache::zn_graph_query_callback(
+  const zn_source_info_t *,
+  const zn_sample_t * sample,
+  const void * arg)
+{
+  auto cache = static_cast<GraphCache *>(const_cast<void *>(arg));
+
+  std::string context_id = sample_context_id(sample);
+  if (context_id == cache->context_id_) {
+    return;
+  }
+  cache->handle_snapshot(context_id, sample->value.val, sample->value.len);
+}
+
+/// REMOTE CONTEXTS ============================================================
+void
+GraphCache::handle_delta(const std::string & context_id, const uint8_t * data, size_t size)
+{
+  uint64_t sequence;
+  std::vector<GraphRecord> records;
+  if (!GraphMessageReader(data, size).read(sequence, records)) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_zenoh_common_cpp", "Discarding malformed graph message from %s", context_id.c_str());
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  RemoteContext & remote = remote_contexts_[context_id];
+  remote.last_seen = Clock::now();
+
+  // Heartbeats carry the sequence number of the last delta, deltas the one after it
+  uint64_t expected_sequence = records.empty() ? remote.sequence : remote.sequence + 1;
+
+  // A context that is heard from for the first time needs no snapshot if nothing was missed, as
+  // it started out without entities
+  if (!remote.synced && sequence == expected_sequence && remote.entities.empty()) {
+    remote.synced = true;
+  }
+  if (!remote.synced || sequence > expected_sequence) {
+    request_snapshot_locked(context_id);
+    return;
+  }
+
+  // Nothing new (or already part of the snapshot)
+  if (records.empty() || sequence <= remote.sequence) {
+    return;
+  }
+
+  for (GraphRecord & record : records) {
+    std::string key = gid_key(record.entity.gid);
+
+    if (record.added) {
+      auto inserted = remote.entities.emplace(key, std::move(record.entity));
+      if (inserted.second) {
+        index_entity(inserted.first->second);
+      }
+    } else {
+      auto it = remote.entities.find(key);
+      if (it != remote.entities.end()) {
+        unindex_entity(it->second);
+        remote.entities.erase(it);
+      }
+    }
+  }
+  remote.sequence = sequence;
+
+  graph_changed_locked();
+}
+
+void
+GraphCache::handle_snapshot(const std::string & context_id, const uint8_t * data, size_t size)
+{
+  uint64_t sequence;
+  std::vector<GraphRecord> records;
+  if (!GraphMessageReader(data, size).read(sequence, records)) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_zenoh_common_cpp", "Discarding malformed graph snapshot from %s", context_id.c_str());
+    return;
+  }
+
+  EntityMap entities;
+  for (GraphRecord & record : records) {
+    if (record.added) {
+      std::string key = gid_key(record.entity.gid);
+      entities.emplace(std::move(key), std::move(record.entity));
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  RemoteContext & remote = remote_contexts_[context_id];
+  remote.last_seen = Clock::now();
+
+  // An older snapshot than the deltas that were already applied
+  if (remote.synced && sequence < remote.sequence) {
+    return;
+  }
+
+  bool changed = entities.size() != remote.entities.size();
+  for (auto it = entities.begin(); !changed && it != entities.end(); ++it) {
+    changed = remote.entities.find(it->first) == remote.entities.end();
+  }
+
+  for (const auto & entity : remote.entities) {
+    unindex_entity(entity.second);
+  }
+  for (const auto & entity : entities) {
+    index_entity(entity.second);
+  }
+  remote.entities = std::move(entities);
+  remote.sequence = sequence;
+  remote.synced = true;
+
+  if (changed) {
+    graph_changed_locked();
+  }
+}
+
+void
+GraphCache::request_snapshot_locked(const std::string & context_id)
+{
+  // Queried by the cache thread, since Zenoh callbacks shouldn't block on a query
+  if (pending_snapshots_.insert(context_id).second) {
+    condition_.notify_one();
+  }
+}
+
+void
+GraphCache::query(const std::string & key)
+{
+  // Every context replies, and the replies mustn't be consolidated
+  zn_query_consolidation_t consolidation;
+  consolidation.first_routers = zn_consolidation_mode_t_NONE;
+  consolidation.last_router = zn_consolidation_mode_t_NONE;
+  consolidation.reception = zn_consolidation_mode_t_NONE;
+
+  zn_query(
+    session_,
+    zn_rname(key.c_str()),
+    "",
+    zn_query_target_default(),
+    consolidation,
+    GraphCache::zn_graph_query_callback,
+    this);
+}
+
+void
+GraphCache::publish(const std::vector<uint8_t> & message)
+{
+  if (zn_write(
+      session_,
+      zn_rid(key_id_),
+      reinterpret_cast<const char *>(message.data()),
+      message.size()) != 0)
+  {
+    RCUTILS_LOG_WARN_NAMED("rmw_zenoh_common_cpp", "Failed to publish graph message");
+  }
+}
+
+void
+GraphCache::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  Clock::time_point next_heartbeat = Clock::now() + HEARTBEAT_PERIOD;
+  while (!stopped_) {
+    Clock::time_point wake_up = next_heartbeat;
+    if (graph_changed_) {
+      wake_up = std::min(wake_up, graph_event_deadline_);
+    }
+
+    // Also woken up by the first change of an event window, to wait for its deadline instead
+    bool graph_changed = graph_changed_;
+    condition_.wait_until(
+      lock, wake_up, [this, graph_changed]() {
+        return stopped_ || !pending_snapshots_.empty() || graph_changed_ != graph_changed;
+      });
+    if (stopped_) {
+      break;
+    }
+    Clock::time_point now = Clock::now();
+
+    // EXPIRE REMOTE CONTEXTS ==================================================
+    bool changed = false;
+    for (auto it = remote_contexts_.begin(); it != remote_contexts_.end(); ) {
+      if (now - it->second.last_seen <= CONTEXT_LEASE) {
+        ++it;
+        continue;
+      }
+      for (const auto & entity : it->second.entities) {
+        unindex_entity(entity.second);
+      }
+      changed = changed || !it->second.entities.empty();
+      it = remote_contexts_.erase(it);
+    }
+    if (changed) {
+      graph_changed_locked();
+    }
+
+    // TRIGGER GRAPH GUARD CONDITIONS ==========================================
+    if (graph_changed_ && now >= graph_event_deadline_) {
+      graph_changed_ = false;
+      trigger_graph_guard_conditions_locked();
+    }
+
+    std::unordered_set<std::string> snapshots;
+    snapshots.swap(pending_snapshots_);
+    bool heartbeat = now >= next_heartbeat;
+
+    // QUERY AND PUBLISH =======================================================
+    lock.unlock();
+
+    for (const std::string & context_id : snapshots) {
+      query(std::string(GRAPH_KEY_PREFIX) + "/" + context_id);
+    }
+
+    if (heartbeat) {
+      std::lock_guard<std::mutex> publish_guard(publish_mutex_);
+      std::vector<uint8_t> message;
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        message = std::move(GraphMessageWriter(local_sequence_).data());
+      }
+      publish(message);
+      next_heartbeat = now + HEARTBEAT_PERIOD;
+    }
+
+    lock.lock();
+  }
+}
+
+/// INDEXES ====================================================================
+void
+GraphCache::index_entity(const EntityInfo & entity)
+{
+  NodeEntities & node = nodes_[std::make_pair(entity.node_namespace, entity.node_name)];
+
+  switch (entity.kind) {
+    case EntityKind::NODE:
+      ++node.node_count;
+      node.enclave = entity.type;
+      break;
+    case EntityKind::PUBLISHER:
+      add_gid(publishers_, entity.name, entity.gid);
+      add_type(topic_types_, entity.name, entity.type);
+      add_type(node.publishers, entity.name, entity.type);
+      update_topic_endpoint_counts_locked(entity.name);
+      break;
+    case EntityKind::SUBSCRIPTION:
+      add_gid(subscriptions_, entity.name, entity.gid);
+      add_type(topic_types_, entity.name, entity.type);
+      add_type(node.subscriptions, entity.name, entity.type);
+      update_topic_endpoint_counts_locked(entity.name);
+      break;
+    case EntityKind::SERVICE:
+      add_gid(services_, entity.name, entity.gid);
+      add_type(service_types_, entity.name, entity.type);
+      add_type(node.services, entity.name, entity.type);
+      break;
+    case EntityKind::CLIENT:
+      add_type(service_types_, entity.name, entity.type);
+      add_type(node.clients, entity.name, entity.type);
+      break;
+  }
+}
+
+void
+GraphCache::unindex_entity(const EntityInfo & entity)
+{
+  auto node_it = nodes_.find(std::make_pair(entity.node_namespace, entity.node_name));
+  if (node_it == nodes_.end()) {
+    return;
+  }
+  NodeEntities & node = node_it->second;
+
+  switch (entity.kind) {
+    case EntityKind::NODE:
+      if (node.node_count > 0) {
+        --node.node_count;
+      }
+      break;
+    case EntityKind::PUBLISHER:
+      remove_gid(publishers_, entity.name, entity.gid);
+      remove_type(topic_types_, entity.name, entity.type);
+      remove_type(node.publishers, entity.name, entity.type);
+      update_topic_endpoint_counts_locked(entity.name);
+      break;
+    case EntityKind::SUBSCRIPTION:
+      remove_gid(subscriptions_, entity.name, entity.gid);
+      remove_type(topic_types_, entity.name, entity.type);
+      remove_type(node.subscriptions, entity.name, entity.type);
+      update_topic_endpoint_counts_locked(entity.name);
+      break;
+    case EntityKind::SERVICE:
+      remove_gid(services_, entity.name, entity.gid);
+      remove_type(service_types_, entity.name, entity.type);
+      remove_type(node.services, entity.name, entity.type);
+      break;
+    case EntityKind::CLIENT:
+      remove_type(service_types_, entity.name, entity.type);
+      remove_type(node.clients, entity.name, entity.type);
+      break;
+  }
+
+  if (node.node_count == 0 && node.publishers.empty() && node.subscriptions.empty() &&
+    node.services.empty() && node.clients.empty())
+  {
+    nodes_.erase(node_it);
+  }
+}
+
+void
+GraphCache::update_topic_endpoint_counts_locked(const std::string & topic_name)
+{
+  auto it = topic_endpoint_counts_.find(topic_name);
+  if (it == topic_endpoint_counts_.end()) {
+    return;
+  }
+
+  std::shared_ptr<TopicEndpointCounts> counts = it->second.lock();
+  if (!counts) {
+    topic_endpoint_counts_.erase(it);
+    return;
+  }
+  counts->publishers.store(count_gids(publishers_, topic_name));
+  counts->subscriptions.store(count_gids(subscriptions_, topic_name));
+}
+
+void
+GraphCache::graph_changed_locked()
+{
+  if (event_window_ == Clock::duration::zero()) {
+    trigger_graph_guard_conditions_locked();
+    return;
+  }
+
+  // The first change opens the event window, the next ones are folded into it
+  if (!graph_changed_) {
+    graph_changed_ = true;
+    graph_event_deadline_ = Clock::now() + event_window_;
+    condition_.notify_one();
+  }
+}
+
+void
+GraphCache::trigger_graph_guard_conditions_locked()
+{
+  for (GuardCondition * guard_condition : guard_conditions_) {
+    guard_condition->trigger();
+  }
+}
+
+}  // namespace rmw_zenoh_common_cpp
@@ -0,0 +1,263 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPL__GRAPH_CACHE_HPP_
+#define IMPL__GRAPH_CACHE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "rcutils/allocator.h"
+#include "rmw/names_and_types.h"
+
+#include "gid.hpp"
+#include "graph_message.hpp"
+
+extern "C"
+{
+#include "rmw_zenoh_common_cpp/zenoh-net-interface.h"
+}
+
+class GuardCondition;
+
+namespace rmw_zenoh_common_cpp
+{
+
+// Topic or service names, to the types they are used with
+using NamesAndTypes = std::map<std::string, std::set<std::string>>;
+
+// Topic or service names, to the number of entities using them with each type
+using TypeCounts = std::map<std::string, std::map<std::string, size_t>>;
+
+// Copy names and types into a zero-initialized rmw_names_and_types_t
+rmw_ret_t copy_names_and_types(
+  const NamesAndTypes & names_and_types,
+  rcutils_allocator_t * allocator,
+  rmw_names_and_types_t * rmw_names_and_types);
+
+// Number of publishers and subscriptions of a topic, in this context and all the others
+//
+// Kept up to date by the graph cache, so it can be read on every publish without locking.
+struct TopicEndpointCounts
+{
+  std::atomic<size_t> publishers{0};
+  std::atomic<size_t> subscriptions{0};
+};
+
+struct NodeName
+{
+  std::string name;
+  std::string namespace_;
+  std::string enclave;
+};
+
+// The ROS graph of all the contexts reachable through a Zenoh session, kept up to date in the
+// background so that graph queries are answered locally, without a network round trip
+//
+// Every context announces its own entities on GRAPH_KEY_PREFIX/<session ID>:
+//  - It publishes the delta whenever one of its entities is added or removed.
+//  - It answers queries on that key with all of its entities, which is how contexts that start
+//    later (or missed a delta) catch up.
+//  - It publishes heartbeats, and the entities of a context that stops sending them are removed.
+// Messages carry a per-context sequence number, so a missed delta is detected from the gap.
+//
+// The graph guard conditions are triggered once per event window, however many changes were
+// applied in it, so bursts of entities coming and going don't wake the nodes over and over.
+class GraphCache
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Graph changes are coalesced for event_window before the guard conditions are triggered
+  // (a zero window triggers them on every change)
+  GraphCache(
+    zn_session_t * session,
+    const uint8_t gid_prefix[GID_PREFIX_SIZE],
+    std::chrono::milliseconds event_window);
+  ~GraphCache();
+
+  GraphCache(const GraphCache &) = delete;
+  GraphCache & operator=(const GraphCache &) = delete;
+
+  // Start announcing the local entities and discovering the remote ones
+  //
+  // Returns false if the Zenoh subscriber or queryable could not be declared.
+  bool start();
+
+  // Stop announcing and discovering (must be called before the session is closed)
+  void stop();
+
+  void add_local_entity(const EntityInfo & entity);
+  void remove_local_entity(const uint8_t gid[GID_SIZE]);
+
+  // Number of publishers or subscriptions of a topic, in this context or any other
+  size_t count_publishers(const std::string & topic_name) const;
+  size_t count_subscriptions(const std::string & topic_name) const;
+
+  // Number of servers of a service, in this context or any other
+  size_t count_services(const std::string & service_name) const;
+
+  // Live endpoint counts of a topic, shared by everyone who asks for the same topic
+  std::shared_ptr<const TopicEndpointCounts> get_topic_endpoint_counts(
+    const std::string & topic_name);
+
+  // GIDs of the servers of a service
+  void get_service_gids(
+    const std::string & service_name, std::vector<std::string> & gids) const;
+
+  // Topics of all the publishers and subscriptions
+  void get_topic_names_and_types(NamesAndTypes & topic_names_and_types) const;
+
+  // Services of all the servers and clients
+  void get_service_names_and_types(NamesAndTypes & service_names_and_types) const;
+
+  // One entry per node (so nodes that share a name are listed as many times)
+  void get_node_names(std::vector<NodeName> & node_names) const;
+
+  // Topics or services of the entities of a given kind of a node
+  //
+  // Returns false if there is no such node.
+  bool get_node_names_and_types(
+    const std::string & node_name,
+    const std::string & node_namespace,
+    EntityKind kind,
+    NamesAndTypes & names_and_types) const;
+
+  // Guard conditions to trigger when the graph changes (the graph guard conditions of the nodes)
+  void add_graph_guard_condition(GuardCondition * guard_condition);
+  void remove_graph_guard_condition(GuardCondition * guard_condition);
+
+private:
+  // Entities keyed by the bytes of their GID
+  using EntityMap = std::unordered_map<std::string, EntityInfo>;
+
+  // Entities of the nodes that share a fully qualified name
+  struct NodeEntities
+  {
+    size_t node_count = 0;
+    std::string enclave;
+
+    TypeCounts publishers;
+    TypeCounts subscriptions;
+    TypeCounts services;
+    TypeCounts clients;
+  };
+
+  struct RemoteContext
+  {
+    EntityMap entities;
+
+    // Sequence number of the last delta applied (or of the snapshot the entities come from)
+    uint64_t sequence = 0;
+
+    // Whether entities is complete (i.e. a snapshot was received and no delta was missed since)
+    bool synced = false;
+
+    Clock::time_point last_seen;
+  };
+
+  static void zn_graph_sub_callback(const zn_sample_t * sample, const void * arg);
+  static void zn_graph_queryable_callback(zn_query_t * query, const void * arg);
+  static void zn_graph_query_callback(
+    const zn_source_info_t * info, const zn_sample_t * sample, const void * arg);
+
+  // Query the snapshots of the contexts matching key, the replies go to zn_graph_query_callback
+  void query(const std::string & key);
+
+  void handle_delta(const std::string & context_id, const uint8_t * data, size_t size);
+  void handle_snapshot(const std::string & context_id, const uint8_t * data, size_t size);
+
+  // Publish a delta or heartbeat (the records are empty for heartbeats)
+  void publish(const std::vector<uint8_t> & message);
+
+  void run();
+
+  // All of these must be called with mutex_ held
+  void index_entity(const EntityInfo & entity);
+  void unindex_entity(const EntityInfo & entity);
+  void request_snapshot_locked(const std::string & context_id);
+  void graph_changed_locked();
+  void trigger_graph_guard_conditions_locked();
+  void update_topic_endpoint_counts_locked(const std::string & topic_name);
+
+  zn_session_t * session_;
+  std::string context_id_;  // Hex session ID, the suffix of the key of this context
+  std::string key_;
+  size_t key_id_;
+
+  zn_subscriber_t * subscriber_;
+  zn_queryable_t * queryable_;
+
+  // Orders publishing, so the deltas go out in sequence order (never held by the Zenoh callbacks)
+  std::mutex publish_mutex_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  bool started_;
+  bool stopped_;
+
+  EntityMap local_entities_;
+  uint64_t local_sequence_;
+
+  // Remote contexts keyed by their ID
+  std::unordered_map<std::string, RemoteContext> remote_contexts_;
+
+  // Remote contexts to query for a snapshot
+  std::unordered_set<std::string> pending_snapshots_;
+
+  /// INDEXES ==================================================================
+  // Kept up to date as entities come and go, so that queries only cost the size of
+  // their result
+
+  // Topic or service name to the GIDs of its publishers, subscriptions or servers
+  std::unordered_map<std::string, std::unordered_set<std::string>> publishers_;
+  std::unordered_map<std::string, std::unordered_set<std::string>> subscriptions_;
+  std::unordered_map<std::string, std::unordered_set<std::string>> services_;
+
+  TypeCounts topic_types_;
+  TypeCounts service_types_;
+
+  // Keyed by node namespace then name
+  std::map<std::pair<std::string, std::string>, NodeEntities> nodes_;
+
+  // Endpoint counts handed out by get_topic_endpoint_counts(), dropped once no one holds them
+  std::unordered_map<std::string, std::weak_ptr<TopicEndpointCounts>> topic_endpoint_counts_;
+
+  std::vector<GuardCondition *> guard_conditions_;
+
+  // Whether the graph changed since the guard conditions were last triggered, in which case they
+  // are triggered at graph_event_deadline_ (by the cache thread)
+  Clock::duration event_window_;
+  bool graph_changed_;
+  Clock::time_point graph_event_deadline_;
+
+  std::thread thread_;
+};
+
+}  // namespace rmw_zenoh_common_cpp
+
+#endif  // IMPL__GRAPH_CACHE_HPP_
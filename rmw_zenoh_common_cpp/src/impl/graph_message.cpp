@@ -0,0 +1,132 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "graph_message.hpp"
+
+#include <cstring>
+#include <utility>
+
+namespace rmw_zenoh_common_cpp
+{
+
+/// GRAPH MESSAGE WRITER =======================================================
+GraphMessageWriter::GraphMessageWriter(uint64_t sequence)
+{
+  write_uint(sequence, sizeof(uint64_t));
+}
+
+void
+GraphMessageWriter::add(const EntityInfo & entity)
+{
+  data_.push_back(RECORD_ADD);
+  data_.push_back(static_cast<uint8_t>(entity.kind));
+  data_.insert(data_.end(), entity.gid, entity.gid + GID_SIZE);
+  write_string(entity.name);
+  write_string(entity.type);
+  write_string(entity.node_name);
+  write_string(entity.node_namespace);
+}
+
+void
+GraphMessageWriter::remove(const uint8_t gid[GID_SIZE])
+{
+  data_.push_back(RECORD_REMOVE);
+  data_.insert(data_.end(), gid, gid + GID_SIZE);
+}
+
+void
+GraphMessageWriter::write_uint(uint64_t value, size_t size)
+{
+  for (size_t i = 0; i < size; ++i) {
+    data_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+void
+GraphMessageWriter::write_string(const std::string & str)
+{
+  write_uint(str.size(), sizeof(uint32_t));
+  data_.insert(data_.end(), str.begin(), str.end());
+}
+
+/// GRAPH MESSAGE READER =======================================================
+bool
+GraphMessageReader::read(uint64_t & sequence, std::vector<GraphRecord> & records)
+{
+  if (!read_uint(sequence, sizeof(uint64_t))) {
+    return false;
+  }
+
+  while (offset_ < size_) {
+    GraphRecord record;
+    uint8_t op = data_[offset_++];
+    record.added = op == RECORD_ADD;
+
+    if (record.added) {
+      if (offset_ == size_) {
+        return false;
+      }
+      if (data_[offset_] > static_cast<uint8_t>(EntityKind::CLIENT)) {
+        return false;
+      }
+      record.entity.kind = static_cast<EntityKind>(data_[offset_++]);
+    }
+
+    if (size_ - offset_ < GID_SIZE) {
+      return false;
+    }
+    std::memcpy(record.entity.gid, data_ + offset_, GID_SIZE);
+    offset_ += GID_SIZE;
+
+    if (record.added && !(
+        read_string(record.entity.name) &&
+        read_string(record.entity.type) &&
+        read_string(record.entity.node_name) &&
+        read_string(record.entity.node_namespace)))
+    {
+      return false;
+    }
+
+    records.push_back(std::move(record));
+  }
+  return true;
+}
+
+bool
+GraphMessageReader::read_uint(uint64_t & value, size_t size)
+{
+  if (size_ - offset_ < size) {
+    return false;
+  }
+  value = 0;
+  for (size_t i = 0; i < size; ++i) {
+    value |= static_cast<uint64_t>(data_[offset_ + i]) << (8 * i);
+  }
+  offset_ += size;
+  return true;
+}
+
+bool
+GraphMessageReader::read_string(std::string & str)
+{
+  uint64_t length;
+  if (!read_uint(length, sizeof(uint32_t)) || size_ - offset_ < length) {
+    return false;
+  }
+  str.assign(reinterpret_cast<const char *>(data_ + offset_), length);
+  offset_ += length;
+  return true;
+}
+
+}  // namespace rmw_zenoh_common_cpp
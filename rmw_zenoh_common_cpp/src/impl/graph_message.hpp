@@ -0,0 +1,109 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPL__GRAPH_MESSAGE_HPP_
+#define IMPL__GRAPH_MESSAGE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gid.hpp"
+
+namespace rmw_zenoh_common_cpp
+{
+
+enum class EntityKind : uint8_t
+{
+  NODE = 0,
+  PUBLISHER = 1,
+  SUBSCRIPTION = 2,
+  SERVICE = 3,
+  CLIENT = 4,
+};
+
+// An entity of the ROS graph, as announced by the context it was created in
+struct EntityInfo
+{
+  EntityKind kind;
+  uint8_t gid[GID_SIZE];
+
+  // Topic or service name (the node name for nodes)
+  std::string name;
+
+  // ROS type name, e.g. "std_msgs/msg/String" (the enclave for nodes)
+  std::string type;
+
+  std::string node_name;
+  std::string node_namespace;
+};
+
+// Graph messages are a sequence number followed by records:
+//   [sequence (8 bytes, LE)] then, for each record, [op (1 byte)] and
+//   - for additions: [kind (1 byte)][GID][name][type][node name][node namespace]
+//   - for removals: [GID]
+// where strings are [length (4 bytes, LE)][bytes]. Heartbeats have no records.
+constexpr uint8_t RECORD_ADD = 1;
+constexpr uint8_t RECORD_REMOVE = 0;
+
+struct GraphRecord
+{
+  bool added;
+  EntityInfo entity;
+};
+
+class GraphMessageWriter
+{
+public:
+  explicit GraphMessageWriter(uint64_t sequence);
+
+  void add(const EntityInfo & entity);
+
+  void remove(const uint8_t gid[GID_SIZE]);
+
+  std::vector<uint8_t> &
+  data()
+  {
+    return data_;
+  }
+
+private:
+  void write_uint(uint64_t value, size_t size);
+  void write_string(const std::string & str);
+
+  std::vector<uint8_t> data_;
+};
+
+class GraphMessageReader
+{
+public:
+  GraphMessageReader(const uint8_t * data, size_t size)
+  : data_(data), size_(size), offset_(0) {}
+
+  // Returns false if the message is malformed
+  bool read(uint64_t & sequence, std::vector<GraphRecord> & records);
+
+private:
+  bool read_uint(uint64_t & value, size_t size);
+  bool read_string(std::string & str);
+
+  const uint8_t * data_;
+  size_t size_;
+  size_t offset_;
+};
+
+}  // namespace rmw_zenoh_common_cpp
+
+#endif  // IMPL__GRAPH_MESSAGE_HPP_
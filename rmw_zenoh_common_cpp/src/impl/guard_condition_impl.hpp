@@ -15,73 +15,53 @@
 #ifndef IMPL__GUARD_CONDITION_IMPL_HPP_
 #define IMPL__GUARD_CONDITION_IMPL_HPP_
 
-#include <array>
 #include <atomic>
-#include <cassert>
-#include <condition_variable>
-#include <mutex>
-#include <utility>
+
+#include "condition_listener.hpp"
 
 class GuardCondition
 {
 public:
   GuardCondition()
-  : hasTriggered_(false),
-    conditionMutex_(nullptr), conditionVariable_(nullptr) {}
+  : hasTriggered_(false) {}
 
+  // Triggering is lock-free unless a wait set is attached to this guard condition. The store to
+  // hasTriggered_ is ordered before the listener's check for an attached wait set, and rmw_wait()
+  // re-checks hasTriggered() after attaching.
   void
   trigger()
   {
-    std::lock_guard<std::mutex> lock(internalMutex_);
-
-    if (conditionMutex_ != nullptr) {
-      std::unique_lock<std::mutex> clock(*conditionMutex_);
-      // the change to hasTriggered_ needs to be mutually exclusive with
-      // rmw_wait() which checks hasTriggered() and decides if wait() needs to
-      // be called
-      hasTriggered_ = true;
-      clock.unlock();
-      conditionVariable_->notify_one();
-    } else {
-      hasTriggered_ = true;
-    }
+    hasTriggered_.store(true);
+    listener_.notify();
   }
 
-  void
-  attachCondition(std::mutex * conditionMutex, std::condition_variable * conditionVariable)
+  bool
+  attachCondition(rmw_wait_set_data_t * waitSet)
   {
-    std::lock_guard<std::mutex> lock(internalMutex_);
-    conditionMutex_ = conditionMutex;
-    conditionVariable_ = conditionVariable;
+    return listener_.attachCondition(waitSet);
   }
 
   void
-  detachCondition()
+  detachCondition(rmw_wait_set_data_t * waitSet)
   {
-    std::lock_guard<std::mutex> lock(internalMutex_);
-    conditionMutex_ = nullptr;
-    conditionVariable_ = nullptr;
+    listener_.detachCondition(waitSet);
   }
 
   bool
   hasTriggered()
   {
-    return hasTriggered_;
+    return hasTriggered_.load();
   }
 
   bool
   getHasTriggered()
   {
-    bool ret = hasTriggered_;
-    hasTriggered_ = false;
-    return ret;
+    return hasTriggered_.exchange(false);
   }
 
 private:
-  std::mutex internalMutex_;
   std::atomic_bool hasTriggered_;
-  std::mutex * conditionMutex_;
-  std::condition_variable * conditionVariable_;
+  ConditionListener listener_;
 };
 
 #endif  // IMPL__GUARD_CONDITION_IMPL_HPP_
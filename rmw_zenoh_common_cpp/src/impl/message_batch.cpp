@@ -0,0 +1,232 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "message_batch.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "rcutils/logging_macros.h"
+
+namespace rmw_zenoh_common_cpp
+{
+
+/// MESSAGE BATCH ==============================================================
+MessageBatch::MessageBatch(
+  BufferPool & buffer_pool,
+  zn_session_t * session,
+  size_t topic_id,
+  const uint8_t * gid,
+  size_t max_size)
+: buffer_pool_(buffer_pool),
+  session_(session),
+  topic_id_(topic_id),
+  gid_(gid),
+  max_size_(max_size),
+  count_(0),
+  flusher_(nullptr)
+{
+}
+
+bool
+MessageBatch::add(uint8_t * data, size_t size)
+{
+  BatchFlusher * flusher = nullptr;
+  bool added;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    added = add_locked(data, size);
+    if (added && count_ == 1) {
+      flusher = flusher_;
+    }
+  }
+
+  // Not holding the batch lock, as the flusher holds its own lock while flushing the batches
+  if (flusher) {
+    flusher->notify_pending();
+  }
+  return added;
+}
+
+bool
+MessageBatch::add_locked(uint8_t * data, size_t size)
+{
+  const size_t entry_size = BATCH_ENTRY_HEADER_SIZE + size;
+
+  // Too big to ever be batched
+  if (BATCH_FRAME_HEADER_SIZE + entry_size > max_size_) {
+    flush_pending_locked();
+    return write(data, size);
+  }
+
+  if (!frame_) {
+    // With room for the publisher GID after a full frame
+    frame_ = buffer_pool_.acquire(max_size_ + PUBLISHER_GID_TRAILER_SIZE);
+    if (!frame_) {
+      return false;
+    }
+    frame_->data()[0] = BATCH_FRAME_MAGIC;
+    std::memset(frame_->data() + 1, 0, BATCH_FRAME_HEADER_SIZE - 1);
+    frame_->set_size(BATCH_FRAME_HEADER_SIZE);
+  }
+
+  if (frame_->size() + entry_size > max_size_) {
+    flush_pending_locked();
+  }
+
+  // APPEND MESSAGE ============================================================
+  uint8_t * entry = frame_->data() + frame_->size();
+  entry[0] = static_cast<uint8_t>(size);
+  entry[1] = static_cast<uint8_t>(size >> 8);
+  entry[2] = static_cast<uint8_t>(size >> 16);
+  entry[3] = static_cast<uint8_t>(size >> 24);
+  std::memcpy(entry + BATCH_ENTRY_HEADER_SIZE, data, size);
+
+  frame_->set_size(frame_->size() + entry_size);
+  ++count_;
+
+  return true;
+}
+
+bool
+MessageBatch::flush()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return flush_locked();
+}
+
+void
+MessageBatch::flush_pending_locked()
+{
+  // The messages of the pending frame were already reported as published, so failing to
+  // write them can only be logged (as the BatchFlusher does), not returned for the current message
+  if (!flush_locked()) {
+    RCUTILS_LOG_WARN_NAMED("rmw_zenoh_common_cpp", "Failed to write batched messages");
+  }
+}
+
+bool
+MessageBatch::flush_locked()
+{
+  if (count_ == 0) {
+    return true;
+  }
+
+  // A lone message is written as it is, there is nothing to gain from framing it
+  // (It is at the end of the frame, so there is room for the publisher GID after it)
+  bool written = count_ == 1 ?
+    write(
+    frame_->data() + BATCH_FRAME_HEADER_SIZE + BATCH_ENTRY_HEADER_SIZE,
+    frame_->size() - BATCH_FRAME_HEADER_SIZE - BATCH_ENTRY_HEADER_SIZE) :
+    write(frame_->data(), frame_->size());
+
+  // The frame buffer is kept for the next batch
+  frame_->set_size(BATCH_FRAME_HEADER_SIZE);
+  count_ = 0;
+
+  return written;
+}
+
+bool
+MessageBatch::write(uint8_t * data, size_t size)
+{
+  std::memcpy(data + size, gid_, PUBLISHER_GID_TRAILER_SIZE);
+  return zn_write(
+    session_,
+    zn_rid(topic_id_),
+    reinterpret_cast<const char *>(data),
+    size + PUBLISHER_GID_TRAILER_SIZE) == 0;
+}
+
+/// BATCH FLUSHER ==============================================================
+BatchFlusher::BatchFlusher(std::chrono::microseconds period)
+: period_(period),
+  stopped_(false),
+  pending_(false),
+  thread_(&BatchFlusher::run, this)
+{
+}
+
+BatchFlusher::~BatchFlusher()
+{
+  stop();
+}
+
+void
+BatchFlusher::add(MessageBatch * batch)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  batches_.push_back(batch);
+
+  std::lock_guard<std::mutex> batch_guard(batch->mutex_);
+  batch->flusher_ = this;
+}
+
+void
+BatchFlusher::remove(MessageBatch * batch)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  batches_.erase(std::remove(batches_.begin(), batches_.end(), batch), batches_.end());
+
+  std::lock_guard<std::mutex> batch_guard(batch->mutex_);
+  batch->flusher_ = nullptr;
+}
+
+void
+BatchFlusher::notify_pending()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    pending_ = true;
+  }
+  condition_.notify_one();
+}
+
+void
+BatchFlusher::stop()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopped_ = true;
+  }
+  condition_.notify_one();
+
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void
+BatchFlusher::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  // The frames are flushed once more after being stopped, so that no message is left
+  // behind in them
+  bool stopping = false;
+  while (!stopping) {
+    // Nothing to do until a message waits in a frame, which is then given a period to fill up
+    condition_.wait(lock, [this]() {return stopped_ || pending_;});
+    stopping = condition_.wait_for(lock, period_, [this]() {return stopped_;});
+    pending_ = false;
+
+    for (MessageBatch * batch : batches_) {
+      if (!batch->flush()) {
+        RCUTILS_LOG_WARN_NAMED("rmw_zenoh_common_cpp", "Failed to write batched messages");
+      }
+    }
+  }
+}
+
+}  // namespace rmw_zenoh_common_cpp
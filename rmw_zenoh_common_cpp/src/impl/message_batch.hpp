@@ -0,0 +1,181 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPL__MESSAGE_BATCH_HPP_
+#define IMPL__MESSAGE_BATCH_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "buffer_pool.hpp"
+#include "gid.hpp"
+
+extern "C"
+{
+#include "rmw_zenoh_common_cpp/zenoh-net-interface.h"
+}
+
+namespace rmw_zenoh_common_cpp
+{
+
+// Batch frame layout
+//
+// A batch frame packs several serialized messages of a topic into one Zenoh payload:
+//   [magic (1 byte)][reserved (3 bytes)] then, for each message, [length (4 bytes, LE)][CDR bytes]
+//
+// Serialized messages start with their CDR encapsulation header, whose first byte is always 0, so
+// a non-zero first byte is enough to tell a batch frame apart from a single message.
+//
+// Like any sample written by a publisher, a frame is followed by the publisher GID (see
+// PUBLISHER_GID_TRAILER_SIZE), which for_each_batched_message() expects to be stripped already.
+constexpr uint8_t BATCH_FRAME_MAGIC = 0xBA;
+constexpr size_t BATCH_FRAME_HEADER_SIZE = 4;
+constexpr size_t BATCH_ENTRY_HEADER_SIZE = 4;
+
+inline bool
+is_batch_frame(const uint8_t * data, size_t size)
+{
+  return size >= BATCH_FRAME_HEADER_SIZE && data[0] == BATCH_FRAME_MAGIC;
+}
+
+// Call f(data, size) on each message of a batch frame, in the order they were published
+//
+// Returns false if the frame is malformed (f is only called on the messages before the error).
+template<typename F>
+bool
+for_each_batched_message(const uint8_t * data, size_t size, F && f)
+{
+  size_t offset = BATCH_FRAME_HEADER_SIZE;
+  while (offset < size) {
+    if (size - offset < BATCH_ENTRY_HEADER_SIZE) {
+      return false;
+    }
+    size_t length =
+      static_cast<size_t>(data[offset]) |
+      static_cast<size_t>(data[offset + 1]) << 8 |
+      static_cast<size_t>(data[offset + 2]) << 16 |
+      static_cast<size_t>(data[offset + 3]) << 24;
+    offset += BATCH_ENTRY_HEADER_SIZE;
+
+    if (size - offset < length) {
+      return false;
+    }
+    f(data + offset, length);
+    offset += length;
+  }
+  return true;
+}
+
+class BatchFlusher;
+
+// Coalesces the serialized messages of a publisher into batch frames
+//
+// A frame is written once the next message wouldn't fit in max_size bytes, or when it is flushed
+// (by the context BatchFlusher, which bounds how long a message can wait in a frame).
+class MessageBatch
+{
+public:
+  // gid is the publisher GID appended to each written sample, it must outlive the batch
+  MessageBatch(
+    BufferPool & buffer_pool,
+    zn_session_t * session,
+    size_t topic_id,
+    const uint8_t * gid,
+    size_t max_size);
+
+  MessageBatch(const MessageBatch &) = delete;
+  MessageBatch & operator=(const MessageBatch &) = delete;
+
+  // Add a serialized message to the frame, writing the frame first if the message doesn't fit
+  //
+  // Messages that don't fit in an empty frame are written on their own (after the pending frame,
+  // so ordering is kept), in which case the publisher GID is appended in place: data must have
+  // PUBLISHER_GID_TRAILER_SIZE spare bytes after size.
+  //
+  // Returns false if this message is lost (Zenoh failed to write it or a buffer can't be
+  // allocated). Failing to write the pending frame is only logged, its messages were already added.
+  bool add(uint8_t * data, size_t size);
+
+  // Write the pending frame, if any
+  bool flush();
+
+private:
+  friend class BatchFlusher;
+
+  bool add_locked(uint8_t * data, size_t size);
+  bool flush_locked();
+  void flush_pending_locked();
+  bool write(uint8_t * data, size_t size);
+
+  BufferPool & buffer_pool_;
+  zn_session_t * session_;
+  size_t topic_id_;
+  const uint8_t * gid_;
+  size_t max_size_;
+
+  std::mutex mutex_;
+  MessageBufferPtr frame_;
+  size_t count_;
+  // Woken up when a message is added to an empty frame, while the batch is added to it
+  BatchFlusher * flusher_;
+};
+
+// Flushes the pending frames of the batching publishers of a context
+//
+// The flusher sleeps until a message is added to an empty frame, and then flushes all the frames
+// one period later, so a message waits at most one period in a frame before it is written.
+class BatchFlusher
+{
+public:
+  explicit BatchFlusher(std::chrono::microseconds period);
+  ~BatchFlusher();
+
+  BatchFlusher(const BatchFlusher &) = delete;
+  BatchFlusher & operator=(const BatchFlusher &) = delete;
+
+  void add(MessageBatch * batch);
+
+  // Once this returns, the batch isn't being flushed and won't be anymore
+  void remove(MessageBatch * batch);
+
+  // Flush all the pending frames one last time, and stop flushing
+  void stop();
+
+private:
+  friend class MessageBatch;
+
+  // Called by a batch once a message is added to its empty frame
+  void notify_pending();
+
+  void run();
+
+  std::chrono::microseconds period_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool stopped_;
+  bool pending_;
+  std::vector<MessageBatch *> batches_;
+
+  std::thread thread_;
+};
+
+}  // namespace rmw_zenoh_common_cpp
+
+#endif  // IMPL__MESSAGE_BATCH_HPP_
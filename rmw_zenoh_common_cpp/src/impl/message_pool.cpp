@@ -0,0 +1,124 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "message_pool.hpp"
+
+#include <memory>
+#include <utility>
+
+#include "rosidl_typesupport_introspection_c/identifier.h"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+
+namespace rmw_zenoh_common_cpp
+{
+
+std::unique_ptr<MessagePool>
+MessagePool::create(
+  const rosidl_message_type_support_t * type_supports,
+  const rcutils_allocator_t & allocator,
+  size_t max_free_messages)
+{
+  // A type support handle only resolves the type supports of its own language, so at
+  // most one of these succeeds
+  const rosidl_message_type_support_t * type_support = get_message_typesupport_handle(
+    type_supports, rosidl_typesupport_introspection_c__identifier);
+  if (type_support) {
+    return std::unique_ptr<MessagePool>(
+      new MessagePool(
+        static_cast<const rosidl_typesupport_introspection_c__MessageMembers *>(
+          type_support->data),
+        nullptr,
+        allocator,
+        max_free_messages));
+  }
+
+  type_support = get_message_typesupport_handle(
+    type_supports, rosidl_typesupport_introspection_cpp::typesupport_identifier);
+  if (type_support) {
+    return std::unique_ptr<MessagePool>(
+      new MessagePool(
+        nullptr,
+        static_cast<const rosidl_typesupport_introspection_cpp::MessageMembers *>(
+          type_support->data),
+        allocator,
+        max_free_messages));
+  }
+
+  return nullptr;
+}
+
+MessagePool::MessagePool(
+  const rosidl_typesupport_introspection_c__MessageMembers * c_members,
+  const rosidl_typesupport_introspection_cpp::MessageMembers * cpp_members,
+  const rcutils_allocator_t & allocator,
+  size_t max_free_messages)
+: c_members_(c_members),
+  cpp_members_(cpp_members),
+  allocator_(allocator),
+  free_messages_(max_free_messages)
+{
+}
+
+MessagePool::~MessagePool()
+{
+  // Messages that are still on loan are not tracked. Loans must be returned before
+  // their publisher or subscription is destroyed.
+  void * message = nullptr;
+  while (free_messages_.try_pop(message)) {
+    destroy(message);
+  }
+}
+
+void *
+MessagePool::acquire()
+{
+  void * message = nullptr;
+  if (free_messages_.try_pop(message)) {
+    return message;
+  }
+
+  size_t size = c_members_ ? c_members_->size_of_ : cpp_members_->size_of_;
+  message = allocator_.allocate(size, allocator_.state);
+  if (!message) {
+    return nullptr;
+  }
+
+  if (c_members_) {
+    c_members_->init_function(message, ROSIDL_RUNTIME_C_MSG_INIT_ALL);
+  } else {
+    cpp_members_->init_function(message, rosidl_runtime_cpp::MessageInitialization::ALL);
+  }
+  return message;
+}
+
+void
+MessagePool::release(void * message)
+{
+  if (!free_messages_.try_push(std::move(message))) {
+    destroy(message);
+  }
+}
+
+void
+MessagePool::destroy(void * message)
+{
+  if (c_members_) {
+    c_members_->fini_function(message);
+  } else {
+    cpp_members_->fini_function(message);
+  }
+  allocator_.deallocate(message, allocator_.state);
+}
+
+}  // namespace rmw_zenoh_common_cpp
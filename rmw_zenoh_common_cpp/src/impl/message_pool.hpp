@@ -0,0 +1,81 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPL__MESSAGE_POOL_HPP_
+#define IMPL__MESSAGE_POOL_HPP_
+
+#include <cstddef>
+#include <memory>
+
+#include "rcutils/allocator.h"
+#include "rosidl_runtime_c/message_type_support_struct.h"
+#include "rosidl_typesupport_introspection_c/message_introspection.h"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
+#include "ring_buffer.hpp"
+
+namespace rmw_zenoh_common_cpp
+{
+
+// Allocates, constructs, and recycles the ROS messages of one type that publishers and
+// subscriptions lend to the user
+//
+// Messages are constructed and destroyed through the introspection type support of their type (C
+// or C++), since the Zenoh type support only knows how to (de)serialize them. Released messages
+// are kept constructed in a bounded lock-free free list, so they keep the memory of their members
+// (e.g. the capacity of C++ sequences) for the next loan.
+class MessagePool
+{
+public:
+  // Returns a null pointer if the type has no introspection type support, in which case its
+  // messages can't be loaned
+  static std::unique_ptr<MessagePool>
+  create(
+    const rosidl_message_type_support_t * type_supports,
+    const rcutils_allocator_t & allocator,
+    size_t max_free_messages);
+
+  ~MessagePool();
+
+  MessagePool(const MessagePool &) = delete;
+  MessagePool & operator=(const MessagePool &) = delete;
+
+  // Get a constructed message, recycled if possible
+  //
+  // Returns nullptr if a new message had to be allocated, and that failed.
+  void * acquire();
+
+  // Give back a message obtained from acquire()
+  void release(void * message);
+
+private:
+  MessagePool(
+    const rosidl_typesupport_introspection_c__MessageMembers * c_members,
+    const rosidl_typesupport_introspection_cpp::MessageMembers * cpp_members,
+    const rcutils_allocator_t & allocator,
+    size_t max_free_messages);
+
+  void destroy(void * message);
+
+  // Only one of them is set, depending on the language of the type support
+  const rosidl_typesupport_introspection_c__MessageMembers * c_members_;
+  const rosidl_typesupport_introspection_cpp::MessageMembers * cpp_members_;
+
+  rcutils_allocator_t allocator_;
+  RingBuffer<void *> free_messages_;
+};
+
+}  // namespace rmw_zenoh_common_cpp
+
+#endif  // IMPL__MESSAGE_POOL_HPP_
@@ -0,0 +1,87 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "pending_requests.hpp"
+
+#include <algorithm>
+
+namespace rmw_zenoh_common_cpp
+{
+
+constexpr size_t PendingRequests::MAX_PENDING_REQUESTS;
+
+void
+PendingRequests::set_timeout(Clock::duration timeout)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  timeout_ = timeout;
+}
+
+void
+PendingRequests::add(int64_t sequence_id)
+{
+  auto now = Clock::now();
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  pending_.emplace(sequence_id, now);
+  order_.emplace_back(sequence_id, now);
+
+  expire_locked(now);
+}
+
+bool
+PendingRequests::complete(int64_t sequence_id)
+{
+  auto now = Clock::now();
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  expire_locked(now);
+
+  return pending_.erase(sequence_id) > 0;
+}
+
+void
+PendingRequests::expire_locked(Clock::time_point now)
+{
+  while (!order_.empty()) {
+    const auto & oldest = order_.front();
+
+    auto it = pending_.find(oldest.first);
+    bool completed = it == pending_.end();
+    bool timed_out = timeout_ != Clock::duration::zero() && now - oldest.second > timeout_;
+
+    if (!completed && !timed_out && pending_.size() <= MAX_PENDING_REQUESTS) {
+      break;
+    }
+
+    if (!completed) {
+      pending_.erase(it);
+    }
+    order_.pop_front();
+  }
+
+  // Completed requests behind a pending one are only dropped once they reach the front, so drop
+  // them all once they make up most of the deque (which keeps it bounded, in amortized O(1))
+  if (order_.size() > 2 * MAX_PENDING_REQUESTS) {
+    order_.erase(
+      std::remove_if(
+        order_.begin(), order_.end(),
+        [this](const std::pair<int64_t, Clock::time_point> & request) {
+          return pending_.find(request.first) == pending_.end();
+        }),
+      order_.end());
+  }
+}
+
+}  // namespace rmw_zenoh_common_cpp
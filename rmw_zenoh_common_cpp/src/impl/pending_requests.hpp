@@ -0,0 +1,75 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPL__PENDING_REQUESTS_HPP_
+#define IMPL__PENDING_REQUESTS_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace rmw_zenoh_common_cpp
+{
+
+// Sequence IDs of the requests of a client that are still waiting for their response
+//
+// Responses are matched against the table as they are received, so responses that weren't asked
+// for (late, duplicate or addressed to another client) are dropped before they are queued.
+// Adding and matching are amortized constant time.
+class PendingRequests
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Pending requests beyond this many are forgotten, oldest first (so lost responses can't leak
+  // entries)
+  static constexpr size_t MAX_PENDING_REQUESTS = 1024;
+
+  PendingRequests()
+  : timeout_(Clock::duration::zero()) {}
+
+  PendingRequests(const PendingRequests &) = delete;
+  PendingRequests & operator=(const PendingRequests &) = delete;
+
+  // Forget the requests that haven't been responded to after timeout (zero never times out)
+  void set_timeout(Clock::duration timeout);
+
+  void add(int64_t sequence_id);
+
+  // Remove the request from the table
+  //
+  // Returns false if it wasn't pending, in which case its response must be dropped.
+  bool complete(int64_t sequence_id);
+
+private:
+  void expire_locked(Clock::time_point now);
+
+  std::mutex mutex_;
+  Clock::duration timeout_;
+
+  // Sequence ID to the time the request was sent
+  std::unordered_map<int64_t, Clock::time_point> pending_;
+
+  // Sequence IDs in the order they were sent, which is also the order they time out in
+  // Completed requests are only removed from here once they reach the front, or on compaction
+  std::deque<std::pair<int64_t, Clock::time_point>> order_;
+};
+
+}  // namespace rmw_zenoh_common_cpp
+
+#endif  // IMPL__PENDING_REQUESTS_HPP_
@@ -14,6 +14,7 @@
 
 #include "pubsub_impl.hpp"
 
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -24,60 +25,192 @@
 #include "rmw_zenoh_common_cpp/TypeSupport.hpp"
 #include "rcutils/logging_macros.h"
 
-std::mutex sub_callback_mutex;
+#include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
 
+#include "buffer_pool.hpp"
+#include "dispatch_table.hpp"
 
 /// STATIC SUBSCRIPTION DATA MEMBERS ===========================================
 std::atomic<size_t> rmw_subscription_data_t::subscription_id_counter(0);
 
-// *INDENT-OFF* because uncrustify can't decide which way to format this
-// Map of Zenoh topic key expression to subscription data
-std::unordered_map<std::string, std::vector<rmw_subscription_data_t *>>
-  rmw_subscription_data_t::zn_topic_to_sub_data;
-// *INDENT-ON*
 
+/// ENQUEUE MESSAGE ============================================================
+// If the queue is full, pop the oldest message to make room for it and try again (rmw_take(),
+// a publisher of the context or another Zenoh thread may get to the freed slot first)
+void
+rmw_subscription_data_t::enqueue_message(
+  rmw_zenoh_common_cpp::MessageBufferPtr entry,
+  const std::string & key)
+{
+  while (!zn_message_queue_->try_push(std::move(entry))) {
+    rmw_zenoh_common_cpp::MessageBufferPtr oldest;
+    if (zn_message_queue_->try_pop(oldest)) {
+      // Log warning if message is discarded due to hitting the queue depth
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_zenoh_common_cpp",
+        "Message queue depth of %ld reached, discarding oldest message "
+        "for subscription for %s (ID: %ld)",
+        queue_depth_,
+        key.c_str(),
+        subscription_id_);
+    }
+  }
+}
 
-/// ZENOH MESSAGE SUBSCRIPTION CALLBACK (static method) ========================
-void rmw_subscription_data_t::zn_sub_callback(const zn_sample_t * sample, const void *)
+namespace
 {
-  std::lock_guard<std::mutex> guard(sub_callback_mutex);
-
-  // NOTE(CH3): We unfortunately have to do this copy construction since we shouldn't be using
-  // char * as keys to the unordered_map
-  std::string key(sample->key.val, sample->key.len);
-
-  // Vector to store the byte array (so we have a copyable container instead of a pointer)
-  std::vector<unsigned char> byte_vec(sample->value.val, sample->value.val + sample->value.len);
-
-  // Get shared pointer to byte array vector
-  // NOTE(CH3): We use a shared pointer to avoid copies and to leverage on the smart pointer's
-  // reference counting
-  auto byte_vec_ptr = std::make_shared<std::vector<unsigned char>>(std::move(byte_vec));
-
-  auto map_iter = rmw_subscription_data_t::zn_topic_to_sub_data.find(key);
-
-  // If the key was not found in the map, it means that there are no RMW subscriptions listening
-  // on this topic, so this message can be dropped without issue
-  if (map_iter != rmw_subscription_data_t::zn_topic_to_sub_data.end()) {
-    // Push shared pointer to message bytes to all associated subscription message queues
-    for (auto it = map_iter->second.begin(); it != map_iter->second.end(); ++it) {
-      std::unique_lock<std::mutex> lock((*it)->message_queue_mutex_);
-
-      if ((*it)->zn_message_queue_.size() >= (*it)->queue_depth_) {
-        // Log warning if message is discarded due to hitting the queue depth
-        RCUTILS_LOG_WARN_NAMED(
-          "rmw_zenoh_common_cpp",
-          "Message queue depth of %ld reached, discarding oldest message "
-          "for subscription for %s (ID: %ld)",
-          (*it)->queue_depth_,
-          key.c_str(),
-          (*it)->subscription_id_);
-
-        (*it)->zn_message_queue_.pop_back();
+// Whether the subscription belongs to the context of the publisher of a sample
+bool
+is_own_sample(const rmw_subscription_data_t * subscription_data, const uint8_t * publisher_gid)
+{
+  return std::memcmp(
+    publisher_gid,
+    subscription_data->node_->context->impl->gid_prefix,
+    rmw_zenoh_common_cpp::GID_PREFIX_SIZE) == 0;
+}
+
+// Copy the CDR bytes of one message into a pooled buffer, followed by the publisher GID
+rmw_zenoh_common_cpp::MessageBufferPtr
+copy_message(
+  rmw_zenoh_common_cpp::BufferPool * buffer_pool,
+  const uint8_t * data,
+  size_t size,
+  const uint8_t * publisher_gid)
+{
+  rmw_zenoh_common_cpp::MessageBufferPtr buffer =
+    buffer_pool->acquire(size + rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE);
+  if (buffer) {
+    std::memcpy(buffer->data(), data, size);
+    std::memcpy(
+      buffer->data() + size, publisher_gid, rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE);
+  }
+  return buffer;
+}
+
+void
+log_allocation_failure(const zn_sample_t * sample)
+{
+  RCUTILS_LOG_ERROR_NAMED(
+    "rmw_zenoh_common_cpp",
+    "Failed to allocate buffer, discarding message for subscription for %.*s",
+    static_cast<int>(sample->key.len),
+    sample->key.val);
+}
+
+// Queue the messages of a batch frame one by one, in order, to each subscription of the fan-out
+void
+dispatch_batch(
+  const rmw_zenoh_common_cpp::TopicFanout<rmw_subscription_data_t> * fanout,
+  const zn_sample_t * sample,
+  const uint8_t * frame,
+  size_t frame_length,
+  const uint8_t * publisher_gid)
+{
+  std::vector<rmw_zenoh_common_cpp::MessageBufferPtr> batched_msg_bytes;
+  bool copied = false;
+
+  fanout->dispatch(
+    [fanout, sample, frame, frame_length, publisher_gid, &batched_msg_bytes, &copied](
+      rmw_subscription_data_t * subscription_data) {
+      if (is_own_sample(subscription_data, publisher_gid)) {
+        return;
       }
-      (*it)->zn_message_queue_.push_front(byte_vec_ptr);
 
-      (*it)->message_queue_mutex_.unlock();
-    }
+      if (!copied) {
+        copied = true;
+        auto buffer_pool = subscription_data->node_->context->impl->buffer_pool;
+        bool allocated = true;
+        bool well_formed = rmw_zenoh_common_cpp::for_each_batched_message(
+          frame, frame_length,
+          [buffer_pool, publisher_gid, &batched_msg_bytes, &allocated](
+            const uint8_t * data, size_t size) {
+            batched_msg_bytes.push_back(copy_message(buffer_pool, data, size, publisher_gid));
+            allocated = allocated && batched_msg_bytes.back();
+          });
+        if (!well_formed) {
+          RCUTILS_LOG_ERROR_NAMED(
+            "rmw_zenoh_common_cpp",
+            "Malformed message batch, discarding the rest of it for %.*s",
+            static_cast<int>(sample->key.len),
+            sample->key.val);
+        }
+        if (!allocated) {
+          log_allocation_failure(sample);
+        }
+      }
+
+      for (const auto & entry : batched_msg_bytes) {
+        if (entry) {
+          subscription_data->enqueue_message(entry, fanout->key());
+        }
+      }
+      subscription_data->condition_listener_.notify();
+    });
+}
+}  // namespace
+
+/// ZENOH MESSAGE SUBSCRIPTION CALLBACK (static method) ========================
+// The callback argument is the fan-out of the Zenoh key expression the subscriber was declared for
+//
+// A sample is either a single serialized message, or a batch frame of several messages of a
+// batching publisher (see message_batch.hpp), which are queued one by one, in order. Either way,
+// it ends with the GID of its publisher.
+//
+// The message bytes are copied into pooled buffers for the first subscription they are delivered
+// to, which the other subscriptions then share.
+//
+// Samples of the publishers of the same context are ignored, as those publishers already handed
+// the messages to the subscriptions (see rmw_zenoh_common_publish()).
+void rmw_subscription_data_t::zn_sub_callback(const zn_sample_t * sample, const void * arg)
+{
+  auto fanout =
+    static_cast<const rmw_zenoh_common_cpp::TopicFanout<rmw_subscription_data_t> *>(arg);
+
+  if (sample->value.len < rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE) {
+    RCUTILS_LOG_ERROR_NAMED(
+      "rmw_zenoh_common_cpp",
+      "Sample too short to carry a publisher GID, discarding it for %.*s",
+      static_cast<int>(sample->key.len),
+      sample->key.val);
+    return;
+  }
+
+  const uint8_t * sample_data = reinterpret_cast<const uint8_t *>(sample->value.val);
+  const size_t sample_length =
+    sample->value.len - rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE;
+  const uint8_t * publisher_gid = sample_data + sample_length;
+
+  if (rmw_zenoh_common_cpp::is_batch_frame(sample_data, sample_length)) {
+    dispatch_batch(fanout, sample, sample_data, sample_length, publisher_gid);
+    return;
   }
+
+  rmw_zenoh_common_cpp::MessageBufferPtr msg_bytes;
+  bool copied = false;
+
+  // If the fan-out has no subscription left, it means that there are no RMW subscriptions
+  // listening on this topic, so this message can be dropped without issue
+  fanout->dispatch(
+    [fanout, sample, sample_data, sample_length, publisher_gid, &msg_bytes, &copied](
+      rmw_subscription_data_t * subscription_data) {
+      if (is_own_sample(subscription_data, publisher_gid)) {
+        return;
+      }
+
+      if (!copied) {
+        copied = true;
+        msg_bytes = copy_message(
+          subscription_data->node_->context->impl->buffer_pool, sample_data, sample_length,
+          publisher_gid);
+        if (!msg_bytes) {
+          log_allocation_failure(sample);
+        }
+      }
+      if (!msg_bytes) {
+        return;
+      }
+
+      subscription_data->enqueue_message(msg_bytes, fanout->key());
+      subscription_data->condition_listener_.notify();
+    });
 }
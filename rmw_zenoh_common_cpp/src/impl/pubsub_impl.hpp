@@ -20,13 +20,21 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <deque>
 #include <mutex>
 #include <atomic>
 
 #include "rmw/rmw.h"
 #include "rmw_zenoh_common_cpp/TypeSupport.hpp"
 
+#include "buffer_pool.hpp"
+#include "condition_listener.hpp"
+#include "dispatch_table.hpp"
+#include "gid.hpp"
+#include "graph_cache.hpp"
+#include "message_batch.hpp"
+#include "message_pool.hpp"
+#include "ring_buffer.hpp"
+
 extern "C"
 {
 #include "rmw_zenoh_common_cpp/zenoh-net-interface.h"
@@ -36,6 +44,8 @@ struct rmw_node_impl_t
 {
 };
 
+struct rmw_subscription_data_t;
+
 struct rmw_publisher_data_t
 {
   const void * type_support_impl_;
@@ -47,6 +57,33 @@ struct rmw_publisher_data_t
   zn_session_t * zn_session_;
 
   const rmw_node_t * node_;
+
+  // Identifies the publisher in the graph
+  uint8_t gid_[rmw_zenoh_common_cpp::GID_SIZE];
+
+  // Endpoints of the topic, from the context graph cache
+  std::shared_ptr<const rmw_zenoh_common_cpp::TopicEndpointCounts> topic_endpoints_;
+
+  // Subscriptions of the context on the topic, which get the messages directly instead of through
+  // Zenoh (the fan-out belongs to the context subscription dispatch table)
+  const rmw_zenoh_common_cpp::TopicFanout<rmw_subscription_data_t> * local_subscriptions_;
+
+  // Messages are only kept for late-joining subscriptions by non-volatile publishers, so volatile
+  // ones skip publishing altogether while the topic has no subscriptions
+  bool skip_unmatched_;
+
+  // Messages are serialized straight into this buffer, which is kept from one publish to the next
+  // and only replaced (from the context buffer pool) by a bigger one when a message doesn't fit,
+  // or when subscriptions of the context still hold the last message that was handed over in it
+  rmw_zenoh_common_cpp::MessageBufferPtr serialize_buffer_;
+  std::mutex serialize_mutex_;
+
+  // Messages lent to the user (null if the type doesn't support loans)
+  std::unique_ptr<rmw_zenoh_common_cpp::MessagePool> loan_pool_;
+
+  // Serialized messages are coalesced into this batch before being written (null if batching is
+  // disabled, in which case each message is written on its own)
+  std::unique_ptr<rmw_zenoh_common_cpp::MessageBatch> batch_;
 };
 
 // Functionally a struct. But with a method for handling incoming Zenoh messages
@@ -55,15 +92,15 @@ struct rmw_subscription_data_t
   /// STATIC MEMBERS ===============================================================================
   static void zn_sub_callback(const zn_sample_t * sample, const void * arg);
 
+  // Push message bytes (followed by the publisher GID) to the message queue, dropping the oldest
+  // message if it is full
+  //
+  // Doesn't notify the condition listener, so that several messages can be pushed first.
+  void enqueue_message(rmw_zenoh_common_cpp::MessageBufferPtr entry, const std::string & key);
+
   // Counter to give subscriptions unique IDs
   static std::atomic<size_t> subscription_id_counter;
 
-  // *INDENT-OFF* because uncrustify can't decide which way to format this
-  // Map of Zenoh topic key expression to subscription data struct instances
-  static std::unordered_map<std::string, std::vector<rmw_subscription_data_t *>>
-    zn_topic_to_sub_data;
-  // *INDENT-ON*
-
   /// INSTANCE MEMBERS =============================================================================
   const void * type_support_impl_;
   const char * typesupport_identifier_;
@@ -72,14 +109,26 @@ struct rmw_subscription_data_t
   const rmw_node_t * node_;
 
   zn_session_t * zn_session_;
-  zn_subscriber_t * zn_subscriber_;
 
   // Instanced message queue
-  std::deque<std::shared_ptr<std::vector<unsigned char>>> zn_message_queue_;
-  std::mutex message_queue_mutex_;
+  // Holds at most queue_depth_ messages, the oldest message is dropped to make room for a new one
+  using MessageQueue = rmw_zenoh_common_cpp::RingBuffer<rmw_zenoh_common_cpp::MessageBufferPtr>;
+  std::unique_ptr<MessageQueue> zn_message_queue_;
+
+  // Wakes the wait set this subscription is attached to when a message is enqueued
+  ConditionListener condition_listener_;
+
+  // Messages lent to the user (null if the type doesn't support loans)
+  std::unique_ptr<rmw_zenoh_common_cpp::MessagePool> loan_pool_;
 
   size_t subscription_id_;
   size_t queue_depth_;
+
+  // Identifies the subscription in the graph
+  uint8_t gid_[rmw_zenoh_common_cpp::GID_SIZE];
+
+  // Endpoints of the topic, from the context graph cache
+  std::shared_ptr<const rmw_zenoh_common_cpp::TopicEndpointCounts> topic_endpoints_;
 };
 
 #endif  // IMPL__PUBSUB_IMPL_HPP_
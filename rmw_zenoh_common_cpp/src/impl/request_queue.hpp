@@ -0,0 +1,119 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPL__REQUEST_QUEUE_HPP_
+#define IMPL__REQUEST_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "buffer_pool.hpp"
+#include "gid.hpp"
+#include "ring_buffer.hpp"
+
+namespace rmw_zenoh_common_cpp
+{
+
+// Request queue of a service, shared fairly between the clients that sent the requests
+//
+// Requests are spread across lanes by client GID, and the lanes are taken from in turn. A client
+// that floods the service only fills its own lane (dropping its own oldest requests), and the
+// requests of the other clients keep being taken at the same rate. Clients whose GIDs hash to the
+// same lane share it.
+//
+// Lock-free for any number of producers (Zenoh callbacks) and consumers (executor threads).
+class RequestQueue
+{
+public:
+  static constexpr size_t LANE_COUNT = 8;
+
+  // Each lane holds at most lane_depth requests
+  explicit RequestQueue(size_t lane_depth)
+  : next_lane_(0)
+  {
+    for (auto & lane : lanes_) {
+      lane.reset(new RingBuffer<MessageBufferPtr>(lane_depth));
+    }
+  }
+
+  RequestQueue(const RequestQueue &) = delete;
+  RequestQueue & operator=(const RequestQueue &) = delete;
+
+  // Returns the number of requests of the same lane that were dropped to make room
+  size_t
+  push(MessageBufferPtr request, const uint8_t client_gid[GID_SIZE])
+  {
+    RingBuffer<MessageBufferPtr> & lane = *lanes_[lane_index(client_gid)];
+
+    size_t dropped = 0;
+    while (!lane.try_push(std::move(request))) {
+      MessageBufferPtr oldest;
+      if (lane.try_pop(oldest)) {
+        ++dropped;
+      }
+    }
+    return dropped;
+  }
+
+  // Returns false if there are no requests
+  bool
+  try_pop(MessageBufferPtr & request)
+  {
+    // Resume from the lane after the last one taken from, so the busy lanes are taken from in
+    // turn (the cursor is only a hint, consumers racing on it still each take a distinct request)
+    size_t first_lane = next_lane_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < LANE_COUNT; ++i) {
+      size_t lane = (first_lane + i) % LANE_COUNT;
+      if (lanes_[lane]->try_pop(request)) {
+        next_lane_.store(lane + 1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool
+  empty() const
+  {
+    for (const auto & lane : lanes_) {
+      if (!lane->empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // The lane the requests of a client are queued in
+  static size_t
+  lane_index(const uint8_t client_gid[GID_SIZE])
+  {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < GID_SIZE; ++i) {
+      hash = (hash ^ client_gid[i]) * 16777619u;
+    }
+    return hash % LANE_COUNT;
+  }
+
+private:
+  std::unique_ptr<RingBuffer<MessageBufferPtr>> lanes_[LANE_COUNT];
+  std::atomic<size_t> next_lane_;
+};
+
+}  // namespace rmw_zenoh_common_cpp
+
+#endif  // IMPL__REQUEST_QUEUE_HPP_
@@ -0,0 +1,154 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IMPL__RING_BUFFER_HPP_
+#define IMPL__RING_BUFFER_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace rmw_zenoh_common_cpp
+{
+
+// Fixed capacity, lock-free, multi-producer multi-consumer FIFO
+//
+// Each cell carries a sequence number telling whether it is ready to be pushed to or popped from
+// for the current lap around the ring (D. Vyukov's bounded MPMC queue). Producers and consumers
+// each claim a position with a CAS, and never wait on each other unless the ring is full or empty.
+//
+// A cell is ready to be pushed to at position p when its sequence is 2p, and to be popped from
+// when it is 2p + 1. (With the original p and p + 1, a ring of one cell can't tell a value waiting
+// at p from a free cell at p + 1.)
+template<typename T>
+class RingBuffer
+{
+public:
+  explicit RingBuffer(size_t capacity)
+  : capacity_(capacity > 0 ? capacity : 1),
+    cells_(new Cell[capacity_]),
+    push_position_(0),
+    pop_position_(0)
+  {
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].sequence.store(2 * i, std::memory_order_relaxed);
+    }
+  }
+
+  RingBuffer(const RingBuffer &) = delete;
+  RingBuffer & operator=(const RingBuffer &) = delete;
+
+  // Returns false (leaving value untouched) if the ring is full
+  bool
+  try_push(T && value)
+  {
+    Cell * cell;
+    size_t position = push_position_.load(std::memory_order_relaxed);
+
+    for (;;) {
+      cell = &cells_[position % capacity_];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      intptr_t lap = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(2 * position);
+
+      if (lap == 0) {
+        if (push_position_.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      } else if (lap < 0) {
+        return false;
+      } else {
+        position = push_position_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = std::move(value);
+    cell->sequence.store(2 * position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Returns false if the ring is empty
+  bool
+  try_pop(T & value)
+  {
+    Cell * cell;
+    size_t position = pop_position_.load(std::memory_order_relaxed);
+
+    for (;;) {
+      cell = &cells_[position % capacity_];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      intptr_t lap = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(2 * position + 1);
+
+      if (lap == 0) {
+        if (pop_position_.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      } else if (lap < 0) {
+        return false;
+      } else {
+        position = pop_position_.load(std::memory_order_relaxed);
+      }
+    }
+
+    value = std::move(cell->value);
+    cell->value = T();
+    cell->sequence.store(2 * (position + capacity_), std::memory_order_release);
+    return true;
+  }
+
+  // Whether the next pop would fail
+  //
+  // A value that is being pushed only counts once its producer is done with it.
+  bool
+  empty() const
+  {
+    size_t position = pop_position_.load(std::memory_order_acquire);
+    const Cell & cell = cells_[position % capacity_];
+    return cell.sequence.load(std::memory_order_acquire) != 2 * position + 1;
+  }
+
+  size_t
+  capacity() const
+  {
+    return capacity_;
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  // The padding keeps the producer and consumer positions on separate cache lines
+  static constexpr size_t kCacheLineSize = 64;
+
+  const size_t capacity_;
+  const std::unique_ptr<Cell[]> cells_;
+
+  char pad0_[kCacheLineSize];
+  std::atomic<size_t> push_position_;
+  char pad1_[kCacheLineSize];
+  std::atomic<size_t> pop_position_;
+  char pad2_[kCacheLineSize];
+};
+
+}  // namespace rmw_zenoh_common_cpp
+
+#endif  // IMPL__RING_BUFFER_HPP_
@@ -14,6 +14,7 @@
 
 #include "service_impl.hpp"
 
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -24,73 +25,73 @@
 #include "rcutils/logging_macros.h"
 #include "rmw_zenoh_common_cpp/TypeSupport.hpp"
 
-std::mutex request_callback_mutex;
+#include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
+
+#include "buffer_pool.hpp"
+#include "dispatch_table.hpp"
+
+// Length of the metadata trailer of requests: the client GID, then the sequence ID
+static constexpr size_t REQUEST_META_LENGTH =
+  rmw_zenoh_common_cpp::GID_SIZE + sizeof(std::int64_t);
 
 /// STATIC SERVICE DATA MEMBERS ================================================
 std::atomic<size_t> rmw_service_data_t::service_id_counter(0);
 
-// *INDENT-OFF* because uncrustify can't decide which way to format this
-// Map of Zenoh topic key expression to service data
-std::unordered_map<std::string, std::vector<rmw_service_data_t *>>
-  rmw_service_data_t::zn_topic_to_service_data;
-// *INDENT-ON*
-
 
 /// ZENOH REQUEST MESSAGE SUBSCRIPTION CALLBACK (static method) ================
-void rmw_service_data_t::zn_request_sub_callback(const zn_sample_t * sample, const void *)
+// The callback argument is the fan-out of the Zenoh key expression the subscriber was declared for
+//
+// Only the fan-out of the key is locked (shared with the other callbacks), and the
+// request queues are lock-free, so requests are received and taken concurrently.
+void rmw_service_data_t::zn_request_sub_callback(const zn_sample_t * sample, const void * arg)
 {
-  std::lock_guard<std::mutex> guard(request_callback_mutex);
-
-  // NOTE(CH3): We unfortunately have to do this copy construction since we shouldn't be using
-  // char * as keys to the unordered_map
-  std::string key(sample->key.val, sample->key.len);
-
-  // Vector to store the byte array (so we have a copyable container instead of a pointer)
-  std::vector<unsigned char> byte_vec(sample->value.val, sample->value.val + sample->value.len);
-
-  // Get shared pointer to byte array vector
-  // NOTE(CH3): We use a shared pointer to avoid copies and to leverage on the smart pointer's
-  // reference counting
-  auto byte_vec_ptr = std::make_shared<std::vector<unsigned char>>(std::move(byte_vec));
+  auto fanout = static_cast<const rmw_zenoh_common_cpp::TopicFanout<rmw_service_data_t> *>(arg);
+
+  // Requests end with the GID of the client, which picks the lane of the request queue
+  if (sample->value.len < REQUEST_META_LENGTH) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rmw_zenoh_common_cpp",
+      "Discarding malformed request for service for %.*s",
+      static_cast<int>(sample->key.len),
+      sample->key.val);
+    return;
+  }
+  const uint8_t * client_gid = sample->value.val + sample->value.len - REQUEST_META_LENGTH;
 
-  auto map_iter = rmw_service_data_t::zn_topic_to_service_data.find(key);
+  // Message bytes, copied into a pooled buffer for the first service they are delivered to
+  rmw_zenoh_common_cpp::MessageBufferPtr msg_bytes;
 
-  // If the key was not found in the map, it means that there are no RMW services listening on this
+  // If the fan-out has no service left, it means that there are no RMW services listening on this
   // topic, so this message can be dropped without issue
-  if (map_iter != rmw_service_data_t::zn_topic_to_service_data.end()) {
-    // Push shared pointer to message bytes to all associated service request message queues
-    for (auto it = map_iter->second.begin(); it != map_iter->second.end(); ++it) {
-      std::unique_lock<std::mutex> lock((*it)->request_queue_mutex_);
+  fanout->dispatch(
+    [sample, client_gid, &msg_bytes](rmw_service_data_t * service_data) {
+      if (!msg_bytes) {
+        auto buffer_pool = service_data->node_->context->impl->buffer_pool;
+        msg_bytes = buffer_pool->acquire(sample->value.len);
+        if (!msg_bytes) {
+          RCUTILS_LOG_ERROR_NAMED(
+            "rmw_zenoh_common_cpp",
+            "Failed to allocate buffer, discarding request for service for %.*s",
+            static_cast<int>(sample->key.len),
+            sample->key.val);
+          return;
+        }
+        std::memcpy(msg_bytes->data(), sample->value.val, sample->value.len);
+      }
 
-      if ((*it)->zn_request_message_queue_.size() >= (*it)->queue_depth_) {
+      // Push message buffer to the service request message queue
+      if (service_data->zn_request_message_queue_->push(msg_bytes, client_gid) > 0) {
         // Log warning if message is discarded due to hitting the queue depth
         RCUTILS_LOG_WARN_NAMED(
           "rmw_zenoh_common_cpp",
-          "Request queue depth of %ld reached, discarding oldest request message "
-          "for service for %s (ID: %ld)",
-          (*it)->queue_depth_,
-          key.c_str(),
-          (*it)->service_id_);
-
-        (*it)->zn_request_message_queue_.pop_back();
+          "Request queue depth of %ld reached for a client, discarding its oldest request message "
+          "for service for %.*s (ID: %ld)",
+          service_data->queue_depth_,
+          static_cast<int>(sample->key.len),
+          sample->key.val,
+          service_data->service_id_);
       }
-      (*it)->zn_request_message_queue_.push_front(byte_vec_ptr);
-
-      (*it)->request_queue_mutex_.unlock();
-    }
-  }
-}
-
-/// ZENOH SERVICE AVAILABILITY QUERYABLE CALLBACK ==============================
-void rmw_service_data_t::zn_service_availability_queryable_callback(
-  zn_query_t * query,
-  const void *)
-{
-  z_string_t resource = zn_query_res_name(query);
-  z_string_t predicate = zn_query_predicate(query);
-
-  std::string res(resource.val, resource.len);
-  std::string response("available");  // NOTE(CH3): The contents actually don't matter...
 
-  zn_send_reply(query, res.c_str(), (const unsigned char *)response.c_str(), response.length());
+      service_data->condition_listener_.notify();
+    });
 }
@@ -20,13 +20,16 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <deque>
-#include <mutex>
 #include <atomic>
 
 #include "rmw/rmw.h"
 #include "rmw_zenoh_common_cpp/TypeSupport.hpp"
 
+#include "buffer_pool.hpp"
+#include "condition_listener.hpp"
+#include "gid.hpp"
+#include "request_queue.hpp"
+
 extern "C"
 {
 #include "rmw_zenoh_common_cpp/zenoh-net-interface.h"
@@ -37,17 +40,9 @@ struct rmw_service_data_t
   /// STATIC MEMBERS ===========================================================
   static void zn_request_sub_callback(const zn_sample_t * sample, const void * arg);
 
-  static void zn_service_availability_queryable_callback(zn_query_t * query, const void * arg);
-
   // Counter to give service servers unique IDs
   static std::atomic<size_t> service_id_counter;
 
-  // *INDENT-OFF* because uncrustify can't decide which way to format this
-  // Map of Zenoh topic key expression to service data struct instances
-  static std::unordered_map<std::string, std::vector<rmw_service_data_t *>>
-    zn_topic_to_service_data;
-  // *INDENT-ON*
-
   /// INSTANCE MEMBERS =========================================================
   // Type support
   const void * request_type_support_impl_;
@@ -58,23 +53,43 @@ struct rmw_service_data_t
   rmw_zenoh_common_cpp::TypeSupport * response_type_support_;
 
   /// ZENOH ====================================================================
+  // Requests and responses are sent over Zenoh pub/sub rather than as Zenoh queries
+  // (zn_query() and zn_send_reply()), which would look like the natural fit for request-reply.
+  // The zenoh-net API can't carry them:
+  //  - A query only carries a string predicate, not a binary payload, so every request would have
+  //    to be text encoded.
+  //  - A zn_query_t is only valid during the queryable callback, so the reply can't be deferred to
+  //    rmw_send_response() without blocking the Zenoh session in the callback until the executor
+  //    gets to the request.
+  // The drawbacks of pub/sub are mitigated instead: responses are addressed to the requesting
+  // client only (see zn_response_topic_key_).
   zn_session_t * zn_session_;
-  zn_queryable_t * zn_queryable_;
 
   // Request Sub
   const char * zn_request_topic_key_;
-  zn_subscriber_t * zn_request_subscriber_;
+
+  // Clients that load balance their requests send each of them to one server only, on
+  // <zn_request_topic_key_>/<service GID>. The clients get the GIDs of the servers from the
+  // context graph cache, which the service is announced to.
+  std::string zn_direct_request_topic_key_;
 
   // Response Pub
+  // Responses are published on <zn_response_topic_key_>/<client GID>, which only the
+  // client that made the request subscribes to
   const char * zn_response_topic_key_;
-  size_t zn_response_topic_id_;
 
   /// ROS ======================================================================
   const rmw_node_t * node_;
 
   // Instanced request message queue
-  std::deque<std::shared_ptr<std::vector<unsigned char>>> zn_request_message_queue_;
-  std::mutex request_queue_mutex_;
+  // Holds at most queue_depth_ requests per client lane (see RequestQueue)
+  std::unique_ptr<rmw_zenoh_common_cpp::RequestQueue> zn_request_message_queue_;
+
+  // Wakes the wait set this service is attached to when a request is enqueued
+  ConditionListener condition_listener_;
+
+  // Globally unique ID, which load balancing clients address requests to
+  uint8_t gid_[rmw_zenoh_common_cpp::GID_SIZE];
 
   size_t service_id_;
   size_t queue_depth_;
@@ -60,6 +60,16 @@ size_t TypeSupport::getEstimatedSerializedSize(const void * ros_message)
   return 4 + members_->get_serialized_size(ros_message);
 }
 
+bool TypeSupport::isBounded() const
+{
+  return max_size_bound_;
+}
+
+size_t TypeSupport::getMaxSerializedSize() const
+{
+  return type_size_;
+}
+
 bool TypeSupport::serializeROSmessage(
   const void * ros_message,
   eprosima::fastcdr::Cdr & ser,
@@ -138,4 +148,16 @@ ResponseTypeSupport::ResponseTypeSupport(const service_type_support_callbacks_t
   set_members(msg);
 }
 
+std::string
+create_type_name(const char * type_namespace, const char * type_name)
+{
+  std::string name(type_namespace);
+  for (const char * separator : {"::", "__"}) {
+    for (size_t i = name.find(separator); i != std::string::npos; i = name.find(separator, i)) {
+      name.replace(i, 2, "/");
+    }
+  }
+  return name + "/" + type_name;
+}
+
 }  // namespace rmw_zenoh_common_cpp
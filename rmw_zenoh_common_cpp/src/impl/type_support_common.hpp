@@ -36,4 +36,14 @@
 #define RMW_ZENOH_CPP_TYPESUPPORT_C rosidl_typesupport_zenoh_c__identifier
 #define RMW_ZENOH_CPP_TYPESUPPORT_CPP rosidl_typesupport_zenoh_cpp::typesupport_identifier
 
+namespace rmw_zenoh_common_cpp
+{
+
+// ROS name of a message or service type, e.g. "std_msgs/msg/String"
+//
+// The namespace is given by the type support, as "std_msgs::msg" for C++ and "std_msgs__msg" for C.
+std::string create_type_name(const char * type_namespace, const char * type_name);
+
+}  // namespace rmw_zenoh_common_cpp
+
 #endif  // IMPL__TYPE_SUPPORT_COMMON_HPP_
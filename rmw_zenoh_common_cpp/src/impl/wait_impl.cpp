@@ -19,7 +19,85 @@
 #include "client_impl.hpp"
 #include "pubsub_impl.hpp"
 
-/// HELPER FUNCTION FOR WAIT ===================================================
+/// HELPER FUNCTIONS FOR WAIT ==================================================
+bool attach_wait_conditions(
+  const rmw_subscriptions_t * subscriptions,
+  const rmw_guard_conditions_t * guard_conditions,
+  const rmw_services_t * services,
+  const rmw_clients_t * clients,
+  rmw_wait_set_data_t * wait_set_data)
+{
+  bool attached = true;
+
+  if (subscriptions) {
+    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
+      auto subscription_data = static_cast<rmw_subscription_data_t *>(
+        subscriptions->subscribers[i]);
+      attached &= subscription_data->condition_listener_.attachCondition(wait_set_data);
+    }
+  }
+
+  if (services) {
+    for (size_t i = 0; i < services->service_count; ++i) {
+      auto service_data = static_cast<rmw_service_data_t *>(services->services[i]);
+      attached &= service_data->condition_listener_.attachCondition(wait_set_data);
+    }
+  }
+
+  if (clients) {
+    for (size_t i = 0; i < clients->client_count; ++i) {
+      auto client_data = static_cast<rmw_client_data_t *>(clients->clients[i]);
+      attached &= client_data->condition_listener_.attachCondition(wait_set_data);
+    }
+  }
+
+  if (guard_conditions) {
+    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
+      auto guard_condition = static_cast<GuardCondition *>(guard_conditions->guard_conditions[i]);
+      attached &= guard_condition->attachCondition(wait_set_data);
+    }
+  }
+
+  return attached;
+}
+
+void detach_wait_conditions(
+  const rmw_subscriptions_t * subscriptions,
+  const rmw_guard_conditions_t * guard_conditions,
+  const rmw_services_t * services,
+  const rmw_clients_t * clients,
+  rmw_wait_set_data_t * wait_set_data)
+{
+  if (subscriptions) {
+    for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
+      auto subscription_data = static_cast<rmw_subscription_data_t *>(
+        subscriptions->subscribers[i]);
+      subscription_data->condition_listener_.detachCondition(wait_set_data);
+    }
+  }
+
+  if (services) {
+    for (size_t i = 0; i < services->service_count; ++i) {
+      auto service_data = static_cast<rmw_service_data_t *>(services->services[i]);
+      service_data->condition_listener_.detachCondition(wait_set_data);
+    }
+  }
+
+  if (clients) {
+    for (size_t i = 0; i < clients->client_count; ++i) {
+      auto client_data = static_cast<rmw_client_data_t *>(clients->clients[i]);
+      client_data->condition_listener_.detachCondition(wait_set_data);
+    }
+  }
+
+  if (guard_conditions) {
+    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
+      auto guard_condition = static_cast<GuardCondition *>(guard_conditions->guard_conditions[i]);
+      guard_condition->detachCondition(wait_set_data);
+    }
+  }
+}
+
 bool check_wait_conditions(
   const rmw_subscriptions_t * subscriptions,
   const rmw_guard_conditions_t * guard_conditions,
@@ -45,7 +123,7 @@ bool check_wait_conditions(
     for (size_t i = 0; i < subscriptions->subscriber_count; ++i) {
       auto subscription_data = static_cast<rmw_subscription_data_t *>(
         subscriptions->subscribers[i]);
-      if (subscription_data->zn_message_queue_.empty()) {
+      if (subscription_data->zn_message_queue_->empty()) {
         if (finalize) {
           // Setting to nullptr lets rcl know that this subscription is not ready
           subscriptions->subscribers[i] = nullptr;
@@ -69,7 +147,7 @@ bool check_wait_conditions(
 
     for (size_t i = 0; i < services->service_count; ++i) {
       auto service_data = static_cast<rmw_service_data_t *>(services->services[i]);
-      if (service_data->zn_request_message_queue_.empty()) {
+      if (service_data->zn_request_message_queue_->empty()) {
         if (finalize) {
           // Setting to nullptr lets rcl know that this service is not ready
           services->services[i] = nullptr;
@@ -94,9 +172,7 @@ bool check_wait_conditions(
 
     for (size_t i = 0; i < clients->client_count; ++i) {
       auto client_data = static_cast<rmw_client_data_t *>(clients->clients[i]);
-      if (client_data->zn_response_message_queue_.empty() &&
-        client_data->zn_availability_query_responses_.empty())
-      {
+      if (client_data->zn_response_message_queue_->empty()) {
         if (finalize) {
           // Setting to nullptr lets rcl know that this client is not ready
           clients->clients[i] = nullptr;
@@ -115,38 +191,32 @@ bool check_wait_conditions(
   }
 
   // GUARD CONDITIONS ==========================================================
-  // STUB: NULLIFY/IGNORE ALL GUARD CONDITIONS FOR NOW
-  for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
-    guard_conditions->guard_conditions[i] = nullptr;
-  }
+  if (guard_conditions) {
+    size_t guard_conditions_ready = 0;
 
-  // NOTE(CH3): TODO(CH3): Uncomment this block when finalizing the RMW implementation
-  // IGNORE GUARD CONDITIONS FOR NOW (They'll keep getting triggered super often, which is good for
-  // responsiveness but not so much for debugging)
+    for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
+      auto guard_condition = static_cast<GuardCondition *>(guard_conditions->guard_conditions[i]);
 
-  // if (guard_conditions) {
-  //   size_t guard_conditions_ready = 0;
-  //
-  //   for (size_t i = 0; i < guard_conditions->guard_condition_count; ++i) {
-  //       auto guard_condition = static_cast<GuardCondition *>(
-  //         guard_conditions->guard_conditions[i]);
-  //       if (guard_condition && guard_condition->hasTriggered()) {
-  //         if (finalize) {
-  //           // Setting to nullptr lets rcl know that this guard_condition is not ready
-  //           guard_conditions->guard_conditions[i] = nullptr;
-  //         }
-  //       } else {
-  //         guard_conditions_ready++;
-  //         stop_wait = true;
-  //       }
-  //   }
-  //
-  //   if (finalize && guard_conditions_ready > 0) {
-  //     RCUTILS_LOG_DEBUG_NAMED(
-  //       "rmw_zenoh_common_cpp", "[rmw_wait] GUARD CONDITIONS READY: %ld",
-  //       guard_conditions_ready);
-  //   }
-  // }
+      // A trigger is consumed by the rmw_wait call that reports it, so only the
+      // finalize pass resets it
+      bool triggered = finalize ? guard_condition->getHasTriggered() :
+        guard_condition->hasTriggered();
+
+      if (triggered) {
+        guard_conditions_ready++;
+        stop_wait = true;
+      } else if (finalize) {
+        // Setting to nullptr lets rcl know that this guard condition is not ready
+        guard_conditions->guard_conditions[i] = nullptr;
+      }
+    }
+
+    if (finalize && guard_conditions_ready > 0) {
+      RCUTILS_LOG_DEBUG_NAMED(
+        "rmw_zenoh_common_cpp", "[rmw_wait] GUARD CONDITIONS READY: %ld",
+        guard_conditions_ready);
+    }
+  }
 
   // EVENTS ====================================================================
   // currently rmw_zenoh_common_cpp does not handle any events. In the future, if it
@@ -15,21 +15,35 @@
 #ifndef IMPL__WAIT_IMPL_HPP_
 #define IMPL__WAIT_IMPL_HPP_
 
-#include <condition_variable>
-#include <mutex>
-
 #include "rmw/rmw.h"
 #include "rmw/event.h"
 
+#include "condition_listener.hpp"
 #include "guard_condition_impl.hpp"
 
-typedef struct rmw_wait_set_data_t
-{
-  std::condition_variable condition;
-  std::mutex condition_mutex;
-} rmw_wait_set_data_t;
+/// HELPER FUNCTIONS FOR WAIT ==================================================
+// Register the wait set with every entity so their Zenoh callbacks and triggers can wake it up
+//
+// Returns false if an entity already had too many wait sets attached, in which case the wait set
+// won't be woken up by that entity (it is still attached to the others and must be detached).
+bool attach_wait_conditions(
+  const rmw_subscriptions_t * subscriptions,
+  const rmw_guard_conditions_t * guard_conditions,
+  const rmw_services_t * services,
+  const rmw_clients_t * clients,
+  rmw_wait_set_data_t * wait_set_data
+);
+
+// Must be called before check_wait_conditions() is called with finalize set, since that nulls out
+// the entities that are not ready
+void detach_wait_conditions(
+  const rmw_subscriptions_t * subscriptions,
+  const rmw_guard_conditions_t * guard_conditions,
+  const rmw_services_t * services,
+  const rmw_clients_t * clients,
+  rmw_wait_set_data_t * wait_set_data
+);
 
-/// HELPER FUNCTION FOR WAIT ===================================================
 bool check_wait_conditions(
   const rmw_subscriptions_t * subscriptions,
   const rmw_guard_conditions_t * guard_conditions,
@@ -12,8 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <unistd.h>
+#include <chrono>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rcutils/logging_macros.h"
@@ -26,11 +27,23 @@
 #include "rmw/rmw.h"
 
 #include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
+#include "rmw_zenoh_common_cpp/rmw_init_options_impl.hpp"
 #include "rmw_zenoh_common_cpp/rmw_zenoh_common.h"
 
+#include "impl/buffer_pool.hpp"
+#include "impl/dispatch_table.hpp"
+#include "impl/gid.hpp"
+#include "impl/graph_cache.hpp"
 #include "impl/type_support_common.hpp"
 #include "impl/client_impl.hpp"
 
+// Response queue depth of clients that leave it to the middleware
+static constexpr size_t DEFAULT_CLIENT_QUEUE_DEPTH = 10;
+
+// Length of the metadata trailer of requests: the client GID, then the sequence ID
+static constexpr size_t REQUEST_META_LENGTH =
+  rmw_zenoh_common_cpp::GID_SIZE + sizeof(std::int64_t);
+
 /// CHECK IF SERVER IS AVAILABLE ===============================================
 // Check if a service server is available for the given service client
 rmw_ret_t
@@ -69,27 +82,9 @@ rmw_zenoh_common_service_server_is_available(
   auto client_data = static_cast<rmw_client_data_t *>(client->data);
 
   // CHECK SERVER AVAILABILITY =================================================
-  // Check if server is alive by querying its availability Zenoh queryable
-  zn_query(
-    client_data->zn_session_,
-    zn_rname(client->service_name),
-    "",  // NOTE(CH3): Maybe use this predicate if we want to more things in the queryable
-    zn_query_target_default(),
-    zn_query_consolidation_default(),
-    rmw_client_data_t::zn_service_availability_query_callback,
-    nullptr);
-
-  std::string key(client->service_name);
-
-  if (client_data->zn_availability_query_responses_.find(key) !=
-    client_data->zn_availability_query_responses_.end())
-  {
-    client_data->zn_availability_query_responses_.erase(key);
-    *result = true;
-  } else {
-    // TODO(CH3): Change this if a better way to throttle availability checks is found
-    sleep(0.5);  // Don't spam the service
-  }
+  // The servers of the service are discovered in the background by the context graph cache
+  *result = client_data->node_->context->impl->graph_cache->count_services(
+    client->service_name) > 0;
 
   return RMW_RET_OK;
 }
@@ -211,6 +206,7 @@ rmw_zenoh_common_create_client(
     (zn_topic_key + "/request").c_str(), *allocator);
   if (!client_data->zn_request_topic_key_) {
     RMW_SET_ERROR_MSG("failed to allocate zenoh request topic key");
+    client_data->~rmw_client_data_t();
     allocator->deallocate(client->data, allocator->state);
 
     allocator->deallocate(const_cast<char *>(client->service_name), allocator->state);
@@ -218,11 +214,14 @@ rmw_zenoh_common_create_client(
     return nullptr;
   }
 
+  rmw_zenoh_common_cpp::generate_gid(node->context->impl->gid_prefix, client_data->gid_);
   client_data->zn_response_topic_key_ = rcutils_strdup(
-    (zn_topic_key + "/response").c_str(), *allocator);
+    (zn_topic_key + "/response/" + rmw_zenoh_common_cpp::gid_to_string(client_data->gid_)).c_str(),
+    *allocator);
   if (!client_data->zn_response_topic_key_) {
     RMW_SET_ERROR_MSG("failed to allocate zenoh response topic key");
     allocator->deallocate(const_cast<char *>(client_data->zn_request_topic_key_), allocator->state);
+    client_data->~rmw_client_data_t();
     allocator->deallocate(client->data, allocator->state);
 
     allocator->deallocate(const_cast<char *>(client->service_name), allocator->state);
@@ -259,6 +258,7 @@ rmw_zenoh_common_create_client(
     allocator->deallocate(const_cast<char *>(client_data->zn_request_topic_key_), allocator->state);
     allocator->deallocate(
       const_cast<char *>(client_data->zn_response_topic_key_), allocator->state);
+    client_data->~rmw_client_data_t();
     allocator->deallocate(client->data, allocator->state);
 
     allocator->deallocate(const_cast<char *>(client->service_name), allocator->state);
@@ -277,6 +277,7 @@ rmw_zenoh_common_create_client(
       const_cast<char *>(client_data->zn_response_topic_key_),
       allocator->state);
     allocator->deallocate(client_data->request_type_support_, allocator->state);
+    client_data->~rmw_client_data_t();
     allocator->deallocate(client->data, allocator->state);
 
     allocator->deallocate(const_cast<char *>(client->service_name), allocator->state);
@@ -293,100 +294,57 @@ rmw_zenoh_common_create_client(
     rmw_client_data_t::client_id_counter.fetch_add(1, std::memory_order_relaxed);
 
   // Configure response message queue
-  client_data->queue_depth_ = qos_profile->depth;
-
-  // ADD CLIENT DATA TO TOPIC MAP ==============================================
-  // This will allow us to access the client data structs for this Zenoh topic key expression
-  // (This is for listening for service responses)
-  std::string topic_key(client_data->zn_response_topic_key_);
-  auto topic_map_iter = rmw_client_data_t::zn_topic_to_client_data.find(topic_key);
-
-  if (topic_map_iter == rmw_client_data_t::zn_topic_to_client_data.end()) {
-    RCUTILS_LOG_DEBUG_NAMED(
-      "rmw_zenoh_common_cpp",
-      "[rmw_create_client] New response topic detected: %s",
-      client_data->zn_response_topic_key_);
-
-    // If no elements for this Zenoh topic key expression exists, add it in
-    std::vector<rmw_client_data_t *> client_data_vec{client_data};
-    rmw_client_data_t::zn_topic_to_client_data[topic_key] = client_data_vec;
-
-    // We initialise subscribers ONCE (otherwise we'll get duplicate messages)
-    // The topic name will be the same for any duplicate subscribers, so it is ok
-    client_data->zn_response_subscriber_ = zn_declare_subscriber(
-      client_data->zn_session_,
-      zn_rname(client_data->zn_response_topic_key_),
-      zn_subinfo_default(),  // NOTE(CH3): Default for now
-      client_data->zn_response_sub_callback,
-      nullptr);
+  // (Its capacity is fixed, so a KEEP_ALL history is also bounded by the depth)
+  client_data->queue_depth_ =
+    qos_profile->depth > 0 ? qos_profile->depth : DEFAULT_CLIENT_QUEUE_DEPTH;
+  client_data->zn_response_message_queue_.reset(
+    new rmw_client_data_t::ResponseQueue(client_data->queue_depth_));
+
+  // Configure request routing
+  client_data->load_balance_ = node->context->options.impl->load_balance_requests;
+  client_data->next_server_ = 0;
+
+  // Configure request timeout
+  client_data->pending_requests_.set_timeout(
+    std::chrono::milliseconds(node->context->options.impl->request_timeout_ms));
+
+  // ADD CLIENT DATA TO DISPATCH TABLE =========================================
+  // This routes the responses received on this Zenoh topic key expression to the client
+  // (The Zenoh subscriber is declared for the first client on the topic)
+  if (!node->context->impl->client_dispatch_table->add(
+      session, client_data->zn_response_topic_key_, client_data))
+  {
+    RMW_SET_ERROR_MSG("failed to declare Zenoh response subscriber for client");
+    allocator->deallocate(const_cast<char *>(client_data->zn_request_topic_key_), allocator->state);
+    allocator->deallocate(
+      const_cast<char *>(client_data->zn_response_topic_key_),
+      allocator->state);
+    allocator->deallocate(client_data->request_type_support_, allocator->state);
+    allocator->deallocate(client_data->response_type_support_, allocator->state);
+    client_data->~rmw_client_data_t();
+    allocator->deallocate(client->data, allocator->state);
 
-    RCUTILS_LOG_DEBUG_NAMED(
-      "rmw_zenoh_common_cpp",
-      "[rmw_create_client] Zenoh subscriber declared for %s",
-      client_data->zn_response_topic_key_);
-  } else {
-    // Otherwise, append to the vector
-    topic_map_iter->second.push_back(client_data);
+    allocator->deallocate(const_cast<char *>(client->service_name), allocator->state);
+    allocator->deallocate(client, allocator->state);
+    return nullptr;
   }
 
   RCUTILS_LOG_DEBUG_NAMED(
     "rmw_zenoh_common_cpp",
-    "[rmw_create_client] Client for %s (ID: %ld) added to topic map",
+    "[rmw_create_client] Client for %s (ID: %ld) added to dispatch table",
     client_data->zn_response_topic_key_,
     client_data->client_id_);
 
-  // ADD CLIENT DATA TO QUERYABLE MAP===========================================
-  // This will allow us to access the client data structs for this Zenoh queryable key expression
-  // (This is for checking service availability)
-  std::string queryable_key(client->service_name);
-  auto queryable_map_iter = rmw_client_data_t::zn_queryable_to_client_data.find(queryable_key);
-
-  if (queryable_map_iter == rmw_client_data_t::zn_queryable_to_client_data.end()) {
-    RCUTILS_LOG_DEBUG_NAMED(
-      "rmw_zenoh_common_cpp",
-      "[rmw_create_client] New queryable detected: %s",
-      client->service_name);
-
-    // If no elements for this Zenoh topic key expression exists, add it in
-    std::vector<rmw_client_data_t *> client_data_vec_{client_data};
-    rmw_client_data_t::zn_queryable_to_client_data[queryable_key] = client_data_vec_;
-  } else {
-    // Otherwise, append to the vector
-    queryable_map_iter->second.push_back(client_data);
-  }
-
-  RCUTILS_LOG_DEBUG_NAMED(
-    "rmw_zenoh_common_cpp",
-    "[rmw_create_client] Client for %s (ID: %ld) added to queryable map",
-    client->service_name,
-    client_data->client_id_);
-
-  // Spoof Zenoh queryable for availability checking
-  //
-  // NOTE(CH3): I know this code chunk looks super super random...
-  // But it is necessary to resolve some as of yet unknown bug that causes the queryable on the
-  // service server side to ignore the queries from a client (if the client is started first)
-  //
-  // I've tested this using pure Zenoh, and the bug doesn't arise. But somehow, despite using
-  // exactly the same code in pure Zenoh, it doesn't want to work here in rmw_zenoh unless this
-  // block is included.
-  //
-  // (Having a listener for queries on a separate process from the service seems to be all that is
-  // necessary.
-  //
-  // Also, the issue is most likely happening on the SERVICE SERVER'session SIDE! But somehow
-  // adding this queryable listener on the SERVICE CLIENT side fixes that issue.
-  //
-  // Additional note: Note that this means that for most use-cases (but not all), we should be fine.
-  // the one edge case is if someone starts a service and client on the same process, but there is
-  // a delay between when the client and service starts (and the client is started first, and there
-  // are no other processes anywhere on the network where the Zenoh queryable is being listened to.)
-  zn_declare_queryable(
-    session,
-    zn_rname(client->service_name),
-    ZN_QUERYABLE_STORAGE,
-    [](zn_query_t *, const void *) {},
-    nullptr);
+  // ANNOUNCE CLIENT ===========================================================
+  rmw_zenoh_common_cpp::EntityInfo entity;
+  entity.kind = rmw_zenoh_common_cpp::EntityKind::CLIENT;
+  memcpy(entity.gid, client_data->gid_, rmw_zenoh_common_cpp::GID_SIZE);
+  entity.name = client->service_name;
+  entity.type = rmw_zenoh_common_cpp::create_type_name(
+    service_members->service_namespace_, service_members->service_name_);
+  entity.node_name = node->name;
+  entity.node_namespace = node->namespace_;
+  node->context->impl->graph_cache->add_local_entity(entity);
 
   return client;
 }
@@ -421,47 +379,24 @@ rmw_zenoh_common_destroy_client(
   // OBTAIN CLIENT MEMBERS =====================================================
   auto client_data = static_cast<rmw_client_data_t *>(client->data);
 
-  // DELETE CLIENT DATA IN TOPIC MAP ===========================================
-  std::string key(client_data->zn_response_topic_key_);
-  auto map_iter = rmw_client_data_t::zn_topic_to_client_data.find(key);
+  // RETRACT CLIENT ============================================================
+  node->context->impl->graph_cache->remove_local_entity(client_data->gid_);
 
-  if (map_iter == rmw_client_data_t::zn_topic_to_client_data.end()) {
+  // DELETE CLIENT DATA IN DISPATCH TABLE ======================================
+  // Only when there are no more active RMW clients listening to this Zenoh topic, is the
+  // subscriber undeclared on Zenoh's end (which means no more Zenoh callbacks will trigger on
+  // this topic)
+  if (!node->context->impl->client_dispatch_table->remove(
+      client_data->zn_response_topic_key_, client_data))
+  {
     RCUTILS_LOG_WARN_NAMED(
       "rmw_zenoh_common_cpp",
-      "client not found in Zenoh topic to client data map! %s",
+      "client not found in Zenoh topic dispatch table! %s",
       client_data->zn_response_topic_key_);
   } else {
-    // Delete the subscription data pointer in the Zenoh topic to subscription data map
-    for (auto it = map_iter->second.begin(); it != map_iter->second.end(); ++it) {
-      if ((*it)->client_id_ == client_data->client_id_) {
-        map_iter->second.erase(it);
-        break;
-      }
-    }
-
-    // Delete the map element if no other client data pointers exist
-    // (That is, when no other clients are listening to the Zenoh response topic)
-    if (map_iter->second.empty()) {
-      RCUTILS_LOG_DEBUG_NAMED(
-        "rmw_zenoh_common_cpp",
-        "[rmw_destroy_client] No more clients listening to %s",
-        client_data->zn_response_topic_key_);
-
-      // Only when there are no more active RMW clients listening to this Zenoh topic, do we
-      // undeclare the subscriber on Zenoh's end (which means no more Zenoh callbacks will trigger
-      // on this topic)
-      zn_undeclare_subscriber(client_data->zn_response_subscriber_);
-      RCUTILS_LOG_DEBUG_NAMED(
-        "rmw_zenoh_common_cpp",
-        "[rmw_destroy_client] Zenoh subcriber undeclared for %s",
-        client_data->zn_response_topic_key_);
-
-      rmw_client_data_t::zn_topic_to_client_data.erase(map_iter);
-    }
-
     RCUTILS_LOG_DEBUG_NAMED(
       "rmw_zenoh_common_cpp",
-      "[rmw_destroy_client] Client for %s (ID: %ld) removed from topic map",
+      "[rmw_destroy_client] Client for %s (ID: %ld) removed from dispatch table",
       client_data->zn_response_topic_key_,
       client_data->client_id_);
   }
@@ -471,6 +406,8 @@ rmw_zenoh_common_destroy_client(
   allocator->deallocate(const_cast<char *>(client_data->zn_response_topic_key_), allocator->state);
   allocator->deallocate(client_data->request_type_support_, allocator->state);
   allocator->deallocate(client_data->response_type_support_, allocator->state);
+  // Returns the buffers still queued to the context buffer pool
+  client_data->~rmw_client_data_t();
   allocator->deallocate(client->data, allocator->state);
 
   allocator->deallocate(const_cast<char *>(client->service_name), allocator->state);
@@ -513,26 +450,23 @@ rmw_zenoh_common_send_request(
   // OBTAIN CLIENT MEMBERS ====================================================
   auto * client_data = static_cast<rmw_client_data_t *>(client->data);
 
-  // ASSIGN ALLOCATOR ==========================================================
-  rcutils_allocator_t * allocator =
-    &(static_cast<rmw_client_data_t *>(client->data)->node_->context->options.allocator);
-
   // SERIALIZE DATA ============================================================
   size_t max_data_length = (
     static_cast<rmw_client_data_t *>(client->data)
     ->request_type_support_->getEstimatedSerializedSize(ros_request));
 
   // Account for metadata
-  max_data_length += sizeof(std::int64_t);  // Internal type of the atomic sequence ID
+  max_data_length += REQUEST_META_LENGTH;
 
   // Init serialized message byte array
-  char * request_bytes = static_cast<char *>(
-    allocator->allocate(max_data_length, allocator->state));
-  if (!request_bytes) {
+  // (Returned to the context buffer pool when request_buffer goes out of scope)
+  rmw_zenoh_common_cpp::MessageBufferPtr request_buffer =
+    client_data->node_->context->impl->buffer_pool->acquire(max_data_length);
+  if (!request_buffer) {
     RMW_SET_ERROR_MSG("failed allocate request message bytes");
-    allocator->deallocate(request_bytes, allocator->state);
     return RMW_RET_ERROR;
   }
+  char * request_bytes = reinterpret_cast<char *>(request_buffer->data());
 
   // Object that manages the raw buffer
   eprosima::fastcdr::FastBuffer fastbuffer(request_bytes, max_data_length);
@@ -549,7 +483,6 @@ rmw_zenoh_common_send_request(
       client_data->request_type_support_impl_))
   {
     RMW_SET_ERROR_MSG("failed serialize ROS request message");
-    allocator->deallocate(request_bytes, allocator->state);
     return RMW_RET_ERROR;
   }
 
@@ -561,24 +494,44 @@ rmw_zenoh_common_send_request(
   // more metadata convenient
   *sequence_id = rmw_client_data_t::sequence_id_counter.fetch_add(1, std::memory_order_relaxed);
 
-  size_t meta_length = sizeof(std::int64_t);  // Internal type of the atomic sequence ID
+  // The client GID tells the service where to send the response
+  memcpy(request_bytes + data_length, client_data->gid_, rmw_zenoh_common_cpp::GID_SIZE);
   memcpy(
-    request_bytes + data_length,
+    request_bytes + data_length + rmw_zenoh_common_cpp::GID_SIZE,
     reinterpret_cast<char *>(sequence_id),
-    meta_length);
+    sizeof(std::int64_t));
+
+  // The response is only accepted while the request is pending
+  client_data->pending_requests_.add(*sequence_id);
 
   // PUBLISH ON ZENOH MIDDLEWARE LAYER =========================================
-  size_t wrid_ret = zn_write(
-    client_data->zn_session_,
-    zn_rid(client_data->zn_request_topic_id_),
-    request_bytes,
-    data_length + meta_length);
+  size_t wrid_ret;
 
-  allocator->deallocate(request_bytes, allocator->state);
+  uint8_t server_gid[rmw_zenoh_common_cpp::GID_SIZE];
+  if (client_data->load_balance_ && client_data->next_server(client->service_name, server_gid)) {
+    // Only the chosen server gets the request
+    std::string server_key(client_data->zn_request_topic_key_);
+    server_key += "/" + rmw_zenoh_common_cpp::gid_to_string(server_gid);
+
+    wrid_ret = zn_write(
+      client_data->zn_session_,
+      zn_rname(server_key.c_str()),
+      request_bytes,
+      data_length + REQUEST_META_LENGTH);
+  } else {
+    // Until a load balancing client knows of a server, it falls back to sending the
+    // request to all of them
+    wrid_ret = zn_write(
+      client_data->zn_session_,
+      zn_rid(client_data->zn_request_topic_id_),
+      request_bytes,
+      data_length + REQUEST_META_LENGTH);
+  }
 
   if (wrid_ret == 0) {
     return RMW_RET_OK;
   } else {
+    client_data->pending_requests_.complete(*sequence_id);
     RMW_SET_ERROR_MSG("zenoh failed to publish request");
     return RMW_RET_ERROR;
   }
@@ -616,13 +569,10 @@ rmw_zenoh_common_take_response(
   // OBTAIN CLIENT MEMBERS =====================================================
   auto client_data = static_cast<rmw_client_data_t *>(client->data);
 
-  // OBTAIN ALLOCATOR ==========================================================
-  rcutils_allocator_t * allocator = &client_data->node_->context->options.allocator;
-
   // RETRIEVE SERIALIZED MESSAGE ===============================================
-  std::unique_lock<std::mutex> lock(client_data->response_queue_mutex_);
+  rmw_zenoh_common_cpp::MessageBufferPtr response_bytes_ptr;
 
-  if (client_data->zn_response_message_queue_.empty()) {
+  if (!client_data->zn_response_message_queue_->try_pop(response_bytes_ptr)) {
     // NOTE(CH3): It is correct to be returning RMW_RET_OK. The information that the message
     // was not found is encoded in the fact that the taken-out parameter is still False.
     //
@@ -630,12 +580,6 @@ rmw_zenoh_common_take_response(
     return RMW_RET_OK;
   }
 
-  // NOTE(CH3): Potential place to handle "QoS" (e.g. could pop from back so it is LIFO)
-  auto response_bytes_ptr = client_data->zn_response_message_queue_.back();
-  client_data->zn_response_message_queue_.pop_back();
-
-  client_data->response_queue_mutex_.unlock();
-
   RCUTILS_LOG_DEBUG_NAMED(
     "rmw_zenoh_common_cpp",
     "[rmw_take] Response found: %s",
@@ -648,18 +592,17 @@ rmw_zenoh_common_take_response(
   // Use metadata
   memcpy(
     &request_header->request_id.sequence_number,
-    &response_bytes_ptr->back() + 1 - meta_length,
+    response_bytes_ptr->data() + response_bytes_ptr->size() - meta_length,
     meta_length);
+  memcpy(request_header->request_id.writer_guid, client_data->gid_, rmw_zenoh_common_cpp::GID_SIZE);
 
   // DESERIALIZE MESSAGE =======================================================
   size_t data_length = response_bytes_ptr->size() - meta_length;
 
-  unsigned char * cdr_buffer = static_cast<unsigned char *>(
-    allocator->allocate(data_length, allocator->state));
-  memcpy(cdr_buffer, &response_bytes_ptr->front(), data_length);
-
-  // Object that manages the raw buffer.
-  eprosima::fastcdr::FastBuffer fastbuffer(reinterpret_cast<char *>(cdr_buffer), data_length);
+  // The queued response bytes are deserialized in place (the metadata trailer is just ignored)
+  eprosima::fastcdr::FastBuffer fastbuffer(
+    reinterpret_cast<char *>(response_bytes_ptr->data()),
+    data_length);
 
   // Object that deserializes the data
   eprosima::fastcdr::Cdr deser(
@@ -674,7 +617,6 @@ rmw_zenoh_common_take_response(
   }
 
   *taken = true;
-  allocator->deallocate(cdr_buffer, allocator->state);
 
   return RMW_RET_OK;
 }
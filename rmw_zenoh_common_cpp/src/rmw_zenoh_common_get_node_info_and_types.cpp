@@ -12,12 +12,82 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <string>
+
 #include "rcutils/logging_macros.h"
 #include "rmw/error_handling.h"
 #include "rmw/get_node_info_and_types.h"
 #include "rmw/rmw.h"
 #include "rmw/names_and_types.h"
 #include "rmw/topic_endpoint_info_array.h"
+#include "rmw/validate_namespace.h"
+#include "rmw/validate_node_name.h"
+
+#include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
+
+#include "impl/graph_cache.hpp"
+
+/// GET NAMES AND TYPES BY NODE ================================================
+// Topics or services of the entities of a given kind of a node, answered from the graph cache
+//
+// Topic names are used as they are in Zenoh keys, so there is nothing to demangle
+static rmw_ret_t
+get_names_and_types_by_node(
+  const rmw_node_t * node,
+  rcutils_allocator_t * allocator,
+  const char * node_name,
+  const char * node_namespace,
+  rmw_zenoh_common_cpp::EntityKind kind,
+  rmw_names_and_types_t * names_and_types)
+{
+  // ASSERTIONS ================================================================
+  RMW_CHECK_ARGUMENT_FOR_NULL(node, RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ALLOCATOR_WITH_MSG(
+    allocator, "allocator argument is invalid", return RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(node_name, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(node_namespace, RMW_RET_INVALID_ARGUMENT);
+
+  int validation_result;
+  rmw_ret_t ret = rmw_validate_node_name(node_name, &validation_result, nullptr);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+  if (validation_result != RMW_NODE_NAME_VALID) {
+    const char * reason = rmw_node_name_validation_result_string(validation_result);
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("node_name argument is invalid: %s", reason);
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  ret = rmw_validate_namespace(node_namespace, &validation_result, nullptr);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+  if (validation_result != RMW_NAMESPACE_VALID) {
+    const char * reason = rmw_namespace_validation_result_string(validation_result);
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("node_namespace argument is invalid: %s", reason);
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  if (rmw_names_and_types_check_zero(names_and_types) != RMW_RET_OK) {
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  // QUERY GRAPH CACHE =========================================================
+  rmw_zenoh_common_cpp::NamesAndTypes node_names_and_types;
+  if (!node->context->impl->graph_cache->get_node_names_and_types(
+      node_name, node_namespace, kind, node_names_and_types))
+  {
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "node %s%s%s not found",
+      node_namespace,
+      std::string(node_namespace) == "/" ? "" : "/",
+      node_name);
+    return RMW_RET_NODE_NAME_NON_EXISTENT;
+  }
+
+  return rmw_zenoh_common_cpp::copy_names_and_types(
+    node_names_and_types, allocator, names_and_types);
+}
 
 rmw_ret_t
 rmw_get_publisher_names_and_types_by_node(
@@ -28,14 +98,11 @@ rmw_get_publisher_names_and_types_by_node(
   bool no_demangle,
   rmw_names_and_types_t * topic_names_and_types)
 {
-  (void)node;
-  (void)allocator;
-  (void)node_name;
-  (void)node_namespace;
   (void)no_demangle;
-  (void)topic_names_and_types;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_get_publisher_names_and_types_by_node");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_get_publisher_names_and_types_by_node");
+  return get_names_and_types_by_node(
+    node, allocator, node_name, node_namespace,
+    rmw_zenoh_common_cpp::EntityKind::PUBLISHER, topic_names_and_types);
 }
 
 rmw_ret_t
@@ -47,14 +114,11 @@ rmw_get_subscriber_names_and_types_by_node(
   bool no_demangle,
   rmw_names_and_types_t * topics_names_and_types)
 {
-  (void)node;
-  (void)allocator;
-  (void)node_name;
-  (void)node_namespace;
   (void)no_demangle;
-  (void)topics_names_and_types;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_get_subscriber_names_and_types_by_node");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_get_subscriber_names_and_types_by_node");
+  return get_names_and_types_by_node(
+    node, allocator, node_name, node_namespace,
+    rmw_zenoh_common_cpp::EntityKind::SUBSCRIPTION, topics_names_and_types);
 }
 
 rmw_ret_t
@@ -65,13 +129,10 @@ rmw_get_service_names_and_types_by_node(
   const char * node_namespace,
   rmw_names_and_types_t * service_names_and_types)
 {
-  (void)node;
-  (void)allocator;
-  (void)node_name;
-  (void)node_namespace;
-  (void)service_names_and_types;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_get_service_names_and_types_by_node");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_get_service_names_and_types_by_node");
+  return get_names_and_types_by_node(
+    node, allocator, node_name, node_namespace,
+    rmw_zenoh_common_cpp::EntityKind::SERVICE, service_names_and_types);
 }
 
 rmw_ret_t
@@ -82,11 +143,8 @@ rmw_get_client_names_and_types_by_node(
   const char * node_namespace,
   rmw_names_and_types_t * client_names_and_types)
 {
-  (void)node;
-  (void)allocator;
-  (void)node_name;
-  (void)node_namespace;
-  (void)client_names_and_types;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_get_client_names_and_types_by_node");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_get_client_names_and_types_by_node");
+  return get_names_and_types_by_node(
+    node, allocator, node_name, node_namespace,
+    rmw_zenoh_common_cpp::EntityKind::CLIENT, client_names_and_types);
 }
@@ -19,15 +19,32 @@
 #include "rmw/names_and_types.h"
 #include "rmw/topic_endpoint_info_array.h"
 
+#include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
+
+#include "impl/graph_cache.hpp"
+
+/// GET SERVICE NAMES AND TYPES ================================================
+// Services of all the servers and clients of the graph, answered from the graph cache
 rmw_ret_t
 rmw_get_service_names_and_types(
   const rmw_node_t * node,
   rcutils_allocator_t * allocator,
   rmw_names_and_types_t * service_names_and_types)
 {
-  (void)node;
-  (void)allocator;
-  (void)service_names_and_types;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_get_service_names_and_types");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_get_service_names_and_types");
+
+  // ASSERTIONS ================================================================
+  RMW_CHECK_ARGUMENT_FOR_NULL(node, RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ALLOCATOR_WITH_MSG(
+    allocator, "allocator argument is invalid", return RMW_RET_INVALID_ARGUMENT);
+  if (rmw_names_and_types_check_zero(service_names_and_types) != RMW_RET_OK) {
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  // QUERY GRAPH CACHE =========================================================
+  rmw_zenoh_common_cpp::NamesAndTypes names_and_types;
+  node->context->impl->graph_cache->get_service_names_and_types(names_and_types);
+
+  return rmw_zenoh_common_cpp::copy_names_and_types(
+    names_and_types, allocator, service_names_and_types);
 }
@@ -19,6 +19,14 @@
 #include "rmw/names_and_types.h"
 #include "rmw/topic_endpoint_info_array.h"
 
+#include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
+
+#include "impl/graph_cache.hpp"
+
+/// GET TOPIC NAMES AND TYPES ==================================================
+// Topics of all the publishers and subscriptions of the graph, answered from the graph cache
+//
+// Topic names are used as they are in Zenoh keys, so there is nothing to demangle
 rmw_ret_t
 rmw_get_topic_names_and_types(
   const rmw_node_t * node,
@@ -26,10 +34,21 @@ rmw_get_topic_names_and_types(
   bool no_demangle,
   rmw_names_and_types_t * topic_names_and_types)
 {
-  (void)node;
-  (void)allocator;
   (void)no_demangle;
-  (void)topic_names_and_types;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_get_topic_names_and_types");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_get_topic_names_and_types");
+
+  // ASSERTIONS ================================================================
+  RMW_CHECK_ARGUMENT_FOR_NULL(node, RMW_RET_INVALID_ARGUMENT);
+  RCUTILS_CHECK_ALLOCATOR_WITH_MSG(
+    allocator, "allocator argument is invalid", return RMW_RET_INVALID_ARGUMENT);
+  if (rmw_names_and_types_check_zero(topic_names_and_types) != RMW_RET_OK) {
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  // QUERY GRAPH CACHE =========================================================
+  rmw_zenoh_common_cpp::NamesAndTypes names_and_types;
+  node->context->impl->graph_cache->get_topic_names_and_types(names_and_types);
+
+  return rmw_zenoh_common_cpp::copy_names_and_types(
+    names_and_types, allocator, topic_names_and_types);
 }
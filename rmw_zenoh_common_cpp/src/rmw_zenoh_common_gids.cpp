@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
+
 #include "rcutils/logging_macros.h"
 
 #include "rmw/topic_endpoint_info_array.h"
@@ -20,12 +22,16 @@
 #include "rmw/names_and_types.h"
 #include "rmw/rmw.h"
 
+#include "impl/gid.hpp"
 #include "impl/pubsub_impl.hpp"
 
 #include "rmw_zenoh_common_cpp/rmw_zenoh_common.h"
 
 /// GET PUBLISHER GID ==========================================================
 // rmw_gid_t Doc: http://docs.ros2.org/latest/api/rmw/structrmw__gid__t.html
+//
+// This is the GID subscriptions report in rmw_message_info_t::publisher_gid for the messages of
+// the publisher, and the one it is announced to the graph with.
 rmw_ret_t
 rmw_zenoh_common_get_gid_for_publisher(
   const rmw_publisher_t * publisher,
@@ -38,24 +44,43 @@ rmw_zenoh_common_get_gid_for_publisher(
     publisher->implementation_identifier,
     eclipse_zenoh_identifier,
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher->data, RMW_RET_ERROR);
   RMW_CHECK_ARGUMENT_FOR_NULL(gid, RMW_RET_INVALID_ARGUMENT);
 
-  // Copy size_t to gid member
+  gid->implementation_identifier = eclipse_zenoh_identifier;
   memset(gid->data, 0, sizeof(gid->data));
   memcpy(
     gid->data,
-    &(static_cast<rmw_publisher_data_t *>(publisher->data)->zn_topic_id_),
-    sizeof(static_cast<rmw_publisher_data_t *>(publisher->data)->zn_topic_id_));
+    static_cast<rmw_publisher_data_t *>(publisher->data)->gid_,
+    rmw_zenoh_common_cpp::GID_SIZE);
 
   return RMW_RET_OK;
 }
 
+/// COMPARE GIDS ===============================================================
+// Both GIDs must come from this implementation, they are equal if they have the same bytes
 rmw_ret_t
-rmw_compare_gids_equal(const rmw_gid_t * gid1, const rmw_gid_t * gid2, bool * result)
+rmw_zenoh_common_compare_gids_equal(
+  const rmw_gid_t * gid1,
+  const rmw_gid_t * gid2,
+  bool * result,
+  const char * const eclipse_zenoh_identifier)
 {
-  (void)gid1;
-  (void)gid2;
-  (void)result;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_compare_gids_equal");
-  return RMW_RET_UNSUPPORTED;
+  RMW_CHECK_ARGUMENT_FOR_NULL(gid1, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    gid1,
+    gid1->implementation_identifier,
+    eclipse_zenoh_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RMW_CHECK_ARGUMENT_FOR_NULL(gid2, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    gid2,
+    gid2->implementation_identifier,
+    eclipse_zenoh_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RMW_CHECK_ARGUMENT_FOR_NULL(result, RMW_RET_INVALID_ARGUMENT);
+
+  *result = memcmp(gid1->data, gid2->data, sizeof(gid1->data)) == 0;
+
+  return RMW_RET_OK;
 }
@@ -12,11 +12,83 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <string>
+#include <vector>
+
 #include "rcutils/logging_macros.h"
+#include "rcutils/strdup.h"
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
 #include "rmw/names_and_types.h"
+#include "rmw/sanity_checks.h"
 #include "rmw/topic_endpoint_info_array.h"
+#include "rmw/validate_full_topic_name.h"
+
+#include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
+
+#include "impl/graph_cache.hpp"
+
+/// GET NODE NAMES =============================================================
+// Names, namespaces (and optionally enclaves) of all the nodes of the graph
+static rmw_ret_t
+get_node_names(
+  const rmw_node_t * node,
+  rcutils_string_array_t * node_names,
+  rcutils_string_array_t * node_namespaces,
+  rcutils_string_array_t * enclaves)
+{
+  // ASSERTIONS ================================================================
+  RMW_CHECK_ARGUMENT_FOR_NULL(node, RMW_RET_INVALID_ARGUMENT);
+  if (rmw_check_zero_rmw_string_array(node_names) != RMW_RET_OK) {
+    return RMW_RET_ERROR;
+  }
+  if (rmw_check_zero_rmw_string_array(node_namespaces) != RMW_RET_OK) {
+    return RMW_RET_ERROR;
+  }
+  if (enclaves && rmw_check_zero_rmw_string_array(enclaves) != RMW_RET_OK) {
+    return RMW_RET_ERROR;
+  }
+
+  // QUERY GRAPH CACHE =========================================================
+  std::vector<rmw_zenoh_common_cpp::NodeName> nodes;
+  node->context->impl->graph_cache->get_node_names(nodes);
+
+  // COPY NAMES ================================================================
+  rcutils_allocator_t * allocator = &node->context->options.allocator;
+
+  auto fini_arrays = [node_names, node_namespaces, enclaves]() {
+      rcutils_string_array_fini(node_names);
+      rcutils_string_array_fini(node_namespaces);
+      if (enclaves) {
+        rcutils_string_array_fini(enclaves);
+      }
+    };
+
+  if (rcutils_string_array_init(node_names, nodes.size(), allocator) != RCUTILS_RET_OK ||
+    rcutils_string_array_init(node_namespaces, nodes.size(), allocator) != RCUTILS_RET_OK ||
+    (enclaves && rcutils_string_array_init(enclaves, nodes.size(), allocator) != RCUTILS_RET_OK))
+  {
+    RMW_SET_ERROR_MSG("failed to allocate node names");
+    fini_arrays();
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    node_names->data[i] = rcutils_strdup(nodes[i].name.c_str(), *allocator);
+    node_namespaces->data[i] = rcutils_strdup(nodes[i].namespace_.c_str(), *allocator);
+    if (enclaves) {
+      enclaves->data[i] = rcutils_strdup(nodes[i].enclave.c_str(), *allocator);
+    }
+
+    if (!node_names->data[i] || !node_namespaces->data[i] || (enclaves && !enclaves->data[i])) {
+      RMW_SET_ERROR_MSG("failed to allocate node name");
+      fini_arrays();
+      return RMW_RET_BAD_ALLOC;
+    }
+  }
+
+  return RMW_RET_OK;
+}
 
 rmw_ret_t
 rmw_get_node_names(
@@ -24,11 +96,8 @@ rmw_get_node_names(
   rcutils_string_array_t * node_names,
   rcutils_string_array_t * node_namespaces)
 {
-  (void)node;
-  (void)node_names;
-  (void)node_namespaces;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_get_node_names");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_get_node_names");
+  return get_node_names(node, node_names, node_namespaces, nullptr);
 }
 
 rmw_ret_t
@@ -38,30 +107,58 @@ rmw_get_node_names_with_enclaves(
   rcutils_string_array_t * node_namespaces,
   rcutils_string_array_t * enclaves)
 {
-  (void)node;
-  (void)node_names;
-  (void)node_namespaces;
-  (void)enclaves;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_get_node_names_with_enclaves");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_get_node_names_with_enclaves");
+  RMW_CHECK_ARGUMENT_FOR_NULL(enclaves, RMW_RET_INVALID_ARGUMENT);
+  return get_node_names(node, node_names, node_namespaces, enclaves);
+}
+
+/// COUNT PUBLISHERS AND SUBSCRIBERS ===========================================
+static rmw_ret_t
+validate_count_arguments(const rmw_node_t * node, const char * topic_name, size_t * count)
+{
+  RMW_CHECK_ARGUMENT_FOR_NULL(node, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(topic_name, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(count, RMW_RET_INVALID_ARGUMENT);
+
+  int validation_result;
+  rmw_ret_t ret = rmw_validate_full_topic_name(topic_name, &validation_result, nullptr);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+  if (validation_result != RMW_TOPIC_VALID) {
+    const char * reason = rmw_full_topic_name_validation_result_string(validation_result);
+    RMW_SET_ERROR_MSG_WITH_FORMAT_STRING("topic_name argument is invalid: %s", reason);
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  return RMW_RET_OK;
 }
 
+// Number of publishers of a topic, in this context and all the others
 rmw_ret_t
 rmw_count_publishers(const rmw_node_t * node, const char * topic_name, size_t * count)
 {
-  (void)node;
-  (void)topic_name;
-  (void)count;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_count_publishers");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_count_publishers");
+
+  rmw_ret_t ret = validate_count_arguments(node, topic_name, count);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+
+  *count = node->context->impl->graph_cache->count_publishers(topic_name);
+  return RMW_RET_OK;
 }
 
+// Number of subscriptions of a topic, in this context and all the others
 rmw_ret_t
 rmw_count_subscribers(const rmw_node_t * node, const char * topic_name, size_t * count)
 {
-  (void)node;
-  (void)topic_name;
-  (void)count;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_count_subscribers");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_count_subscribers");
+
+  rmw_ret_t ret = validate_count_arguments(node, topic_name, count);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+
+  *count = node->context->impl->graph_cache->count_subscriptions(topic_name);
+  return RMW_RET_OK;
 }
@@ -14,9 +14,11 @@
 
 // Doc: http://docs.ros2.org/latest/api/rmw/init_8h.html
 
+#include <chrono>
 #include <cstring>
 
 #include <memory>
+#include <utility>
 
 #include "rmw/impl/cpp/macros.hpp"
 #include "rmw/error_handling.h"
@@ -31,6 +33,56 @@
 #include "rmw_zenoh_common_cpp/rmw_zenoh_common.h"
 #include "rmw_zenoh_common_cpp/zenoh-net-interface.h"
 
+#include "impl/buffer_pool.hpp"
+#include "impl/message_batch.hpp"
+#include "impl/dispatch_table.hpp"
+#include "impl/gid.hpp"
+#include "impl/graph_cache.hpp"
+#include "impl/pubsub_impl.hpp"
+#include "impl/service_impl.hpp"
+#include "impl/client_impl.hpp"
+
+namespace
+{
+template<typename T, typename ... Args>
+T * allocate_and_construct(rcutils_allocator_t * allocator, Args && ... args)
+{
+  void * memory = allocator->allocate(sizeof(T), allocator->state);
+  if (!memory) {
+    return nullptr;
+  }
+  return new(memory) T(std::forward<Args>(args)...);
+}
+
+template<typename T>
+void destruct_and_deallocate(rcutils_allocator_t * allocator, T * object)
+{
+  if (object) {
+    object->~T();
+    allocator->deallocate(object, allocator->state);
+  }
+}
+
+void fini_context_impl_members(rcutils_allocator_t * allocator, rmw_context_impl_t * impl)
+{
+  destruct_and_deallocate(allocator, impl->subscription_dispatch_table);
+  destruct_and_deallocate(allocator, impl->service_dispatch_table);
+  destruct_and_deallocate(allocator, impl->batch_flusher);
+  destruct_and_deallocate(allocator, impl->client_dispatch_table);
+  destruct_and_deallocate(allocator, impl->graph_cache);
+
+  impl->subscription_dispatch_table = nullptr;
+  impl->service_dispatch_table = nullptr;
+  impl->client_dispatch_table = nullptr;
+  impl->batch_flusher = nullptr;
+  impl->graph_cache = nullptr;
+
+  // Destroyed last, the dispatch tables could be holding on to buffers
+  destruct_and_deallocate(allocator, impl->buffer_pool);
+  impl->buffer_pool = nullptr;
+}
+}  // namespace
+
 /// INIT CONTEXT ===============================================================
 // Initialize the middleware with the given options, and yielding an context.
 //
@@ -41,6 +93,17 @@
 //  - RMW_ZENOH_SESSION_LOCATOR: Session TCP locator to use
 //  - RMW_ZENOH_MODE: Lets you set the session to be in CLIENT, ROUTER, or PEER mode
 //                    (defaults to PEER)
+//  - RMW_ZENOH_PUBLISH_BATCH_SIZE: Coalesce the messages of each publisher into frames of up to
+//                                  this many bytes (batching is disabled if unset or 0)
+//  - RMW_ZENOH_PUBLISH_BATCH_PERIOD_US: Max time in microseconds a message waits in a frame
+//                                       (defaults to 1000)
+//  - RMW_ZENOH_SERVICE_ROUTING: Set to ROUND_ROBIN to send each request to one of the servers of
+//                               the service in turn (by default, all servers get every request)
+//  - RMW_ZENOH_REQUEST_TIMEOUT_MS: Drop the responses that arrive this many milliseconds after
+//                                  their request was sent (requests never time out if unset or 0)
+//  - RMW_ZENOH_GRAPH_EVENT_WINDOW_MS: Graph changes within this many milliseconds wake the graph
+//                                     guard conditions once (defaults to 10, 0 wakes them on
+//                                     every change)
 rmw_ret_t
 rmw_zenoh_common_init_pre(
   const rmw_init_options_t * options, rmw_context_t * context,
@@ -94,6 +157,98 @@ rmw_zenoh_common_init_pre(
   return RMW_RET_OK;
 }
 
+/// POST-INIT CONTEXT ==========================================================
+// Set up the implementation specific members of a context.
+//
+// Called by rmw_init() once the Zenoh session is open and assigned to context->impl, before any
+// entity is created on it.
+rmw_ret_t
+rmw_zenoh_common_init_post(rmw_context_t * context, const char * const eclipse_zenoh_identifier)
+{
+  // ASSERTIONS ================================================================
+  RMW_CHECK_ARGUMENT_FOR_NULL(context, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_FOR_NULL_WITH_MSG(
+    context->impl,
+    "expected initialized context",
+    return RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    context,
+    context->implementation_identifier,
+    eclipse_zenoh_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  // OBTAIN ALLOCATOR ==========================================================
+  rcutils_allocator_t * allocator = &context->options.allocator;
+  rmw_context_impl_t * impl = context->impl;
+
+  // OBTAIN GID PREFIX =========================================================
+  static_assert(
+    sizeof(impl->gid_prefix) == rmw_zenoh_common_cpp::GID_PREFIX_SIZE,
+    "GID prefix size mismatch");
+  rmw_zenoh_common_cpp::get_session_gid_prefix(impl->session, impl->gid_prefix);
+
+  // CREATE BUFFER POOL ========================================================
+  impl->buffer_pool = allocate_and_construct<rmw_zenoh_common_cpp::BufferPool>(
+    allocator, *allocator);
+  if (!impl->buffer_pool) {
+    RMW_SET_ERROR_MSG("failed to allocate context buffer pool");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  // CREATE BATCH FLUSHER =====================================================
+  impl->batch_flusher = nullptr;
+  if (context->options.impl->publish_batch_size > 0) {
+    impl->batch_flusher = allocate_and_construct<rmw_zenoh_common_cpp::BatchFlusher>(
+      allocator, std::chrono::microseconds(context->options.impl->publish_batch_period_us));
+    if (!impl->batch_flusher) {
+      RMW_SET_ERROR_MSG("failed to allocate context batch flusher");
+      destruct_and_deallocate(allocator, impl->buffer_pool);
+      impl->buffer_pool = nullptr;
+      return RMW_RET_BAD_ALLOC;
+    }
+  }
+
+  // CREATE DISPATCH TABLES ====================================================
+  impl->graph_cache = nullptr;
+  impl->subscription_dispatch_table =
+    allocate_and_construct<rmw_zenoh_common_cpp::DispatchTable<rmw_subscription_data_t>>(
+    allocator, rmw_subscription_data_t::zn_sub_callback);
+  impl->service_dispatch_table =
+    allocate_and_construct<rmw_zenoh_common_cpp::DispatchTable<rmw_service_data_t>>(
+    allocator, rmw_service_data_t::zn_request_sub_callback);
+  impl->client_dispatch_table =
+    allocate_and_construct<rmw_zenoh_common_cpp::DispatchTable<rmw_client_data_t>>(
+    allocator, rmw_client_data_t::zn_response_sub_callback);
+
+  if (!impl->subscription_dispatch_table || !impl->service_dispatch_table ||
+    !impl->client_dispatch_table)
+  {
+    RMW_SET_ERROR_MSG("failed to allocate context dispatch tables");
+    fini_context_impl_members(allocator, impl);
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  // START GRAPH DISCOVERY =====================================================
+  impl->graph_cache = allocate_and_construct<rmw_zenoh_common_cpp::GraphCache>(
+    allocator,
+    impl->session,
+    impl->gid_prefix,
+    std::chrono::milliseconds(context->options.impl->graph_event_window_ms));
+  if (!impl->graph_cache) {
+    RMW_SET_ERROR_MSG("failed to allocate context graph cache");
+    fini_context_impl_members(allocator, impl);
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  if (!impl->graph_cache->start()) {
+    RMW_SET_ERROR_MSG("failed to declare Zenoh graph discovery subscriber or queryable");
+    fini_context_impl_members(allocator, impl);
+    return RMW_RET_ERROR;
+  }
+
+  return RMW_RET_OK;
+}
+
 /// SHUTDOWN CONTEXT ===========================================================
 // Shutdown the middleware for a given context.
 //
@@ -118,6 +273,12 @@ rmw_zenoh_common_shutdown(rmw_context_t * context, const char * const eclipse_ze
   // CLEANUP ===================================================================
   // Close Zenoh session
   if (context->impl->is_shutdown == false) {
+    // Write the messages still waiting in batch frames while the session is open
+    if (context->impl->batch_flusher) {
+      context->impl->batch_flusher->stop();
+    }
+    // Tell the other contexts that the entities of this one are gone
+    context->impl->graph_cache->stop();
     zn_close(context->impl->session);
     context->impl->is_shutdown = true;
   }
@@ -153,6 +314,8 @@ rmw_zenoh_common_context_fini(rmw_context_t * context, const char * const eclips
 
   // CLEANUP ===================================================================
   // Deallocate implementation specific members
+  // (The session is closed, so no Zenoh callbacks can be using them anymore)
+  fini_context_impl_members(allocator, context->impl);
   allocator->deallocate(context->impl, allocator->state);
 
   // Reset context
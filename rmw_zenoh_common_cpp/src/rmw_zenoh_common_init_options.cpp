@@ -14,6 +14,9 @@
 
 // Doc: http://docs.ros2.org/latest/api/rmw/init__options_8h.html
 
+#include <cstdlib>
+#include <cstring>
+
 #include "rmw/impl/cpp/macros.hpp"
 #include "rmw/error_handling.h"
 #include "rmw/init_options.h"
@@ -26,6 +29,12 @@
 #include "rmw_zenoh_common_cpp/rmw_zenoh_common.h"
 #include "rmw_zenoh_common_cpp/rmw_init_options_impl.hpp"
 
+// Batch frames are flushed at least this often if RMW_ZENOH_PUBLISH_BATCH_PERIOD_US isn't set
+static constexpr size_t DEFAULT_PUBLISH_BATCH_PERIOD_US = 1000;
+
+// Graph changes are coalesced for this long if RMW_ZENOH_GRAPH_EVENT_WINDOW_MS isn't set
+static constexpr size_t DEFAULT_GRAPH_EVENT_WINDOW_MS = 10;
+
 // Helper case-insensitive string comparison function
 int strcicmp(char const * a, char const * b)
 {
@@ -133,6 +142,60 @@ rmw_zenoh_common_init_options_init(
     return RMW_RET_BAD_ALLOC;
   }
 
+  // Populate publisher batching (disabled unless a batch size is given)
+  const char * batch_size_env_value;
+  if (nullptr != rcutils_get_env("RMW_ZENOH_PUBLISH_BATCH_SIZE", &batch_size_env_value)) {
+    RMW_SET_ERROR_MSG("error trying to retrieve RMW_ZENOH_PUBLISH_BATCH_SIZE env var");
+    return RMW_RET_ERROR;
+  }
+  init_options->impl->publish_batch_size = std::strtoull(batch_size_env_value, nullptr, 10);
+
+  const char * batch_period_env_value;
+  if (nullptr != rcutils_get_env("RMW_ZENOH_PUBLISH_BATCH_PERIOD_US", &batch_period_env_value)) {
+    RMW_SET_ERROR_MSG("error trying to retrieve RMW_ZENOH_PUBLISH_BATCH_PERIOD_US env var");
+    return RMW_RET_ERROR;
+  }
+  init_options->impl->publish_batch_period_us = std::strtoull(batch_period_env_value, nullptr, 10);
+  if (init_options->impl->publish_batch_period_us == 0) {
+    init_options->impl->publish_batch_period_us = DEFAULT_PUBLISH_BATCH_PERIOD_US;
+  }
+
+  // Populate service request routing (requests are sent to all servers unless round-robin is set)
+  const char * service_routing_env_value;
+  if (nullptr != rcutils_get_env("RMW_ZENOH_SERVICE_ROUTING", &service_routing_env_value)) {
+    RMW_SET_ERROR_MSG("error trying to retrieve RMW_ZENOH_SERVICE_ROUTING env var");
+    return RMW_RET_ERROR;
+  }
+  init_options->impl->load_balance_requests =
+    strcicmp(service_routing_env_value, "ROUND_ROBIN") == 0;
+
+  // Populate request timeout (requests never time out unless a timeout is given)
+  const char * request_timeout_env_value;
+  if (nullptr != rcutils_get_env("RMW_ZENOH_REQUEST_TIMEOUT_MS", &request_timeout_env_value)) {
+    RMW_SET_ERROR_MSG("error trying to retrieve RMW_ZENOH_REQUEST_TIMEOUT_MS env var");
+    return RMW_RET_ERROR;
+  }
+  init_options->impl->request_timeout_ms = std::strtoull(request_timeout_env_value, nullptr, 10);
+
+  // Populate graph event coalescing (an explicit 0 triggers graph guards on every change)
+  const char * graph_window_env_value;
+  if (nullptr != rcutils_get_env("RMW_ZENOH_GRAPH_EVENT_WINDOW_MS", &graph_window_env_value)) {
+    RMW_SET_ERROR_MSG("error trying to retrieve RMW_ZENOH_GRAPH_EVENT_WINDOW_MS env var");
+    return RMW_RET_ERROR;
+  }
+  init_options->impl->graph_event_window_ms = graph_window_env_value[0] == '\0' ?
+    DEFAULT_GRAPH_EVENT_WINDOW_MS : std::strtoull(graph_window_env_value, nullptr, 10);
+
+  // Populate message loaning (disabled unless enabled, since rclcpp returns a loaned message right
+  // after the callback, even if the callback kept it)
+  const char * loan_messages_env_value;
+  if (nullptr != rcutils_get_env("RMW_ZENOH_LOAN_MESSAGES", &loan_messages_env_value)) {
+    RMW_SET_ERROR_MSG("error trying to retrieve RMW_ZENOH_LOAN_MESSAGES env var");
+    return RMW_RET_ERROR;
+  }
+  init_options->impl->loan_messages =
+    strcicmp(loan_messages_env_value, "TRUE") == 0 || strcmp(loan_messages_env_value, "1") == 0;
+
   return RMW_RET_OK;
 }
 
@@ -203,6 +266,13 @@ rmw_zenoh_common_init_options_copy(
     return RMW_RET_BAD_ALLOC;
   }
 
+  tmp.impl->publish_batch_size = src->impl->publish_batch_size;
+  tmp.impl->publish_batch_period_us = src->impl->publish_batch_period_us;
+  tmp.impl->load_balance_requests = src->impl->load_balance_requests;
+  tmp.impl->request_timeout_ms = src->impl->request_timeout_ms;
+  tmp.impl->graph_event_window_ms = src->impl->graph_event_window_ms;
+  tmp.impl->loan_messages = src->impl->loan_messages;
+
   // NOTE(CH3): No security yet
   // tmp.security_options = rmw_get_zero_initialized_security_options();
   // rmw_ret_t ret =
@@ -14,6 +14,8 @@
 
 // Doc: http://docs.ros2.org/latest/api/rmw/rmw_8h.html
 
+#include <cstring>
+
 #include "rmw/impl/cpp/macros.hpp"
 #include "rmw/validate_node_name.h"
 #include "rmw/validate_namespace.h"
@@ -29,6 +31,10 @@
 
 #include "rmw_zenoh_common_cpp/rmw_zenoh_common.h"
 
+#include "impl/gid.hpp"
+#include "impl/graph_cache.hpp"
+#include "impl/guard_condition_impl.hpp"
+
 /// CREATE NODE ================================================================
 // Create a node and return a handle to that node.
 //
@@ -167,16 +173,21 @@ rmw_zenoh_common_create_node(
   // NOTE(CH3): Only for DDS
   // node_impl->domain_id_ = domain_id;
 
-  // NOTE(CH3) TODO(CH3): No graph updates are implemented yet
-  // I am not sure how this will work with Zenoh
+  // Triggered by the context graph cache whenever the graph changes
+  context->impl->graph_cache->add_graph_guard_condition(
+    static_cast<GuardCondition *>(node_data->graph_guard_condition_->data));
+
+  // ANNOUNCE NODE =============================================================
+  rmw_zenoh_common_cpp::generate_gid(context->impl->gid_prefix, node_data->gid_);
 
-  // TODO(CH3): For when we need to have a guard condition
-  // node_impl->graph_guard_condition = rmw_zenoh_common_create_guard_condition(
-  //   context, eclipse_zenoh_identifier);
-  // if (!node_impl->graph_guard_condition) {
-  //   RMW_SET_ERROR_MSG("node implementation graph_guard_condition already set");
-  //   return nullptr;
-  // }
+  rmw_zenoh_common_cpp::EntityInfo entity;
+  entity.kind = rmw_zenoh_common_cpp::EntityKind::NODE;
+  memcpy(entity.gid, node_data->gid_, rmw_zenoh_common_cpp::GID_SIZE);
+  entity.name = node->name;
+  entity.type = context->options.enclave ? context->options.enclave : "";
+  entity.node_name = node->name;
+  entity.node_namespace = node->namespace_;
+  context->impl->graph_cache->add_local_entity(entity);
 
   return node;
 }
@@ -194,15 +205,19 @@ rmw_zenoh_common_destroy_node(rmw_node_t * node, const char * const eclipse_zeno
     eclipse_zenoh_identifier,
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
 
-  // NOTE(CH3) TODO(CH3): Again, no graph updates are implemented yet
-  // I am not sure how this will work with Zenoh
-
   RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "[rmw_destroy_node] %s", node->name);
 
   // OBTAIN ALLOCATOR ==========================================================
   rcutils_allocator_t * allocator = &node->context->options.allocator;
 
   // CLEANUP ===================================================================
+  node->context->impl->graph_cache->remove_local_entity(
+    static_cast<rmw_node_impl_t *>(node->data)->gid_);
+
+  node->context->impl->graph_cache->remove_graph_guard_condition(
+    static_cast<GuardCondition *>(
+      static_cast<rmw_node_impl_t *>(node->data)->graph_guard_condition_->data));
+
   const rmw_ret_t destroyed = rmw_destroy_guard_condition(
     static_cast<rmw_node_impl_t *>(node->data)->graph_guard_condition_);
   if (destroyed != RMW_RET_OK) {
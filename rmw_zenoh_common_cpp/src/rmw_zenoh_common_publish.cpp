@@ -14,6 +14,13 @@
 
 #include <fastcdr/FastBuffer.h>
 #include <fastcdr/Cdr.h>
+#include <fastcdr/exceptions/NotEnoughMemoryException.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <utility>
 
 #include "rcutils/logging_macros.h"
 
@@ -22,12 +29,133 @@
 #include "rmw/event.h"
 #include "rmw/rmw.h"
 
+#include "impl/buffer_pool.hpp"
+#include "impl/dispatch_table.hpp"
+#include "impl/gid.hpp"
+#include "impl/message_batch.hpp"
 #include "impl/type_support_common.hpp"
 #include "impl/pubsub_impl.hpp"
 
+#include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
 #include "rmw_zenoh_common_cpp/rmw_zenoh_common.h"
 #include "rmw_zenoh_common_cpp/zenoh-net-interface.h"
 
+// Whether a message can be dropped without being serialized or written
+//
+// Subscriptions are known from their announcements, so one that was just created in
+// another context may miss messages until its announcement arrives, as with DDS discovery.
+static bool
+is_unmatched(const rmw_publisher_data_t * publisher_data)
+{
+  return publisher_data->skip_unmatched_ &&
+         publisher_data->topic_endpoints_->subscriptions.load(std::memory_order_relaxed) == 0;
+}
+
+// Write serialized message bytes on the publisher's topic, batched if batching is enabled
+//
+// The publisher GID is appended in place, so data must have PUBLISHER_GID_TRAILER_SIZE spare bytes
+// after data_length.
+static bool
+write_serialized_message(
+  rmw_publisher_data_t * publisher_data,
+  uint8_t * data,
+  size_t data_length)
+{
+  if (publisher_data->batch_) {
+    return publisher_data->batch_->add(data, data_length);
+  }
+
+  std::memcpy(
+    data + data_length, publisher_data->gid_, rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE);
+  return zn_write(
+    publisher_data->zn_session_,
+    zn_rid(publisher_data->zn_topic_id_),
+    reinterpret_cast<const char *>(data),
+    data_length + rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE) == 0;
+}
+
+// Get the publisher's serialization buffer ready for a message of up to capacity bytes
+//
+// The buffer is only replaced if it is too small, or if subscriptions of the context still hold
+// the last message that was handed over in it (see deliver_to_local_subscriptions()), in which
+// case it goes back to the pool once they took that message.
+static rmw_ret_t
+prepare_serialize_buffer(rmw_publisher_data_t * publisher_data, size_t capacity)
+{
+  rmw_zenoh_common_cpp::MessageBufferPtr & msg_buffer = publisher_data->serialize_buffer_;
+  if (msg_buffer.unique() && msg_buffer->capacity() >= capacity) {
+    return RMW_RET_OK;
+  }
+
+  rmw_zenoh_common_cpp::MessageBufferPtr replacement =
+    publisher_data->node_->context->impl->buffer_pool->acquire(
+    std::max(capacity, msg_buffer->capacity()));
+  if (!replacement) {
+    RMW_SET_ERROR_MSG("failed to allocate message bytes");
+    return RMW_RET_BAD_ALLOC;
+  }
+  msg_buffer = std::move(replacement);
+  return RMW_RET_OK;
+}
+
+// Hand the publisher's serialization buffer over to the subscriptions of the context on the topic
+//
+// The subscriptions share the buffer (it is only read from), so the message is neither copied nor
+// looped back through Zenoh. The publisher keeps its handle, and only needs another buffer for the
+// next message if they haven't all taken this one by then (see prepare_serialize_buffer()).
+static void
+deliver_to_local_subscriptions(
+  rmw_publisher_data_t * publisher_data,
+  const rmw_zenoh_common_cpp::MessageBufferPtr & msg_buffer,
+  size_t data_length)
+{
+  std::memcpy(
+    msg_buffer->data() + data_length,
+    publisher_data->gid_,
+    rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE);
+  msg_buffer->set_size(data_length + rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE);
+
+  const rmw_zenoh_common_cpp::TopicFanout<rmw_subscription_data_t> * fanout =
+    publisher_data->local_subscriptions_;
+  fanout->dispatch(
+    [fanout, &msg_buffer](rmw_subscription_data_t * subscription_data) {
+      subscription_data->enqueue_message(msg_buffer, fanout->key());
+      subscription_data->condition_listener_.notify();
+    });
+}
+
+// Publish the serialized message in the publisher's serialization buffer
+//
+// The message is written through Zenoh for the subscriptions of other contexts, and handed to the
+// ones of this context directly. msg_buffer must have room for the publisher GID after the
+// message.
+static rmw_ret_t
+publish_serialized(
+  rmw_publisher_data_t * publisher_data,
+  const rmw_zenoh_common_cpp::MessageBufferPtr & msg_buffer,
+  size_t data_length)
+{
+  const size_t local_subscriptions = publisher_data->local_subscriptions_->size();
+
+  // Subscriptions ignore the samples of their own context, so there is no point in
+  // writing the message if all the subscriptions of the topic are local, unless it is kept for
+  // late-joining ones.
+  const bool has_remote_subscriptions =
+    publisher_data->topic_endpoints_->subscriptions.load(std::memory_order_relaxed) >
+    local_subscriptions;
+  if (!publisher_data->skip_unmatched_ || has_remote_subscriptions) {
+    if (!write_serialized_message(publisher_data, msg_buffer->data(), data_length)) {
+      RMW_SET_ERROR_MSG("zenoh failed to publish message");
+      return RMW_RET_ERROR;
+    }
+  }
+
+  if (local_subscriptions > 0) {
+    deliver_to_local_subscriptions(publisher_data, msg_buffer, data_length);
+  }
+  return RMW_RET_OK;
+}
+
 /// PUBLISH ROS MESSAGE ========================================================
 // Serialize and publish a ROS message using Zenoh.
 rmw_ret_t
@@ -56,76 +184,144 @@ rmw_zenoh_common_publish(
   auto publisher_data = static_cast<rmw_publisher_data_t *>(publisher->data);
   RMW_CHECK_ARGUMENT_FOR_NULL(publisher_data, RMW_RET_ERROR);
 
-  // ASSIGN ALLOCATOR ==========================================================
-  rcutils_allocator_t * allocator =
-    &(static_cast<rmw_publisher_data_t *>(publisher->data)->node_->context->options.allocator);
+  // No one would receive the message
+  if (is_unmatched(publisher_data)) {
+    return RMW_RET_OK;
+  }
 
   // SERIALIZE DATA ============================================================
-  size_t max_data_length = (static_cast<rmw_publisher_data_t *>(publisher->data)
-    ->type_support_->getEstimatedSerializedSize(ros_message));
-
-  // Init serialized message byte array
-  char * msg_bytes = static_cast<char *>(allocator->allocate(max_data_length, allocator->state));
-
-  // Object that manages the raw buffer
-  eprosima::fastcdr::FastBuffer fastbuffer(msg_bytes, max_data_length);
-
-  // Object that serializes the data
-  eprosima::fastcdr::Cdr ser(
-    fastbuffer,
-    eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
-    eprosima::fastcdr::Cdr::DDS_CDR);
-  if (!publisher_data->type_support_->serializeROSmessage(
-      ros_message,
-      ser,
-      publisher_data->type_support_impl_))
-  {
-    RMW_SET_ERROR_MSG("could not serialize ROS message");
-    allocator->deallocate(msg_bytes, allocator->state);
-    return RMW_RET_ERROR;
+  // The message is serialized without sizing it first. If it doesn't fit in the
+  // publisher's serialization buffer, FastCDR throws, and we retry with a buffer twice as big.
+  std::lock_guard<std::mutex> guard(publisher_data->serialize_mutex_);
+  rmw_ret_t ret = prepare_serialize_buffer(
+    publisher_data, publisher_data->serialize_buffer_->capacity());
+  if (ret != RMW_RET_OK) {
+    return ret;
   }
+  rmw_zenoh_common_cpp::MessageBufferPtr & msg_buffer = publisher_data->serialize_buffer_;
 
-  size_t data_length = ser.getSerializedDataLength();
-
-  // PUBLISH ON ZENOH MIDDLEWARE LAYER =========================================
-  size_t wrid_ret = zn_write(
-    publisher_data->zn_session_,
-    zn_rid(publisher_data->zn_topic_id_),
-    msg_bytes,
-    data_length);
+  size_t data_length = 0;
+  for (;;) {
+    // Object that manages the raw buffer (minus the room for the publisher GID)
+    eprosima::fastcdr::FastBuffer fastbuffer(
+      reinterpret_cast<char *>(msg_buffer->data()),
+      msg_buffer->capacity() - rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE);
 
-  allocator->deallocate(msg_bytes, allocator->state);
+    // Object that serializes the data
+    eprosima::fastcdr::Cdr ser(
+      fastbuffer,
+      eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+      eprosima::fastcdr::Cdr::DDS_CDR);
 
-  if (wrid_ret == 0) {
-    return RMW_RET_OK;
-  } else {
-    RMW_SET_ERROR_MSG("zenoh failed to publish response");
-    return RMW_RET_ERROR;
+    try {
+      if (!publisher_data->type_support_->serializeROSmessage(
+          ros_message,
+          ser,
+          publisher_data->type_support_impl_))
+      {
+        RMW_SET_ERROR_MSG("could not serialize ROS message");
+        return RMW_RET_ERROR;
+      }
+      data_length = ser.getSerializedDataLength();
+      break;
+    } catch (const eprosima::fastcdr::exception::NotEnoughMemoryException &) {
+      // Grow the buffer (the old one goes back to the context buffer pool)
+      rmw_zenoh_common_cpp::MessageBufferPtr bigger_buffer =
+        publisher_data->node_->context->impl->buffer_pool->acquire(2 * msg_buffer->capacity());
+      if (!bigger_buffer) {
+        RMW_SET_ERROR_MSG("failed to allocate message bytes");
+        return RMW_RET_BAD_ALLOC;
+      }
+      msg_buffer = std::move(bigger_buffer);
+    }
   }
+
+  // PUBLISH MESSAGE ===========================================================
+  return publish_serialized(publisher_data, msg_buffer, data_length);
 }
 
+/// PUBLISH SERIALIZED MESSAGE =================================================
+// Publish an already serialized ROS message using Zenoh.
+//
+// The CDR bytes are written as they are, so they reach subscriptions exactly as if
+// rmw_publish() had serialized them. They are copied to the publisher's serialization buffer
+// first, as the user's buffer has no room for the publisher GID.
 rmw_ret_t
-rmw_publish_serialized_message(
+rmw_zenoh_common_publish_serialized_message(
   const rmw_publisher_t * publisher,
   const rmw_serialized_message_t * serialized_message,
-  rmw_publisher_allocation_t * allocation)
+  rmw_publisher_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier)
 {
-  (void)publisher;
-  (void)serialized_message;
-  (void)allocation;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_publish_serialized_message");
-  return RMW_RET_UNSUPPORTED;
+  (void) allocation;
+
+  // ASSERTIONS ================================================================
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(serialized_message, RMW_RET_INVALID_ARGUMENT);
+
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    eclipse_zenoh_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto publisher_data = static_cast<rmw_publisher_data_t *>(publisher->data);
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher_data, RMW_RET_ERROR);
+
+  RCUTILS_LOG_DEBUG_NAMED(
+    "rmw_zenoh_common_cpp", "[rmw_publish_serialized_message] %s (%ld)",
+    publisher->topic_name,
+    publisher_data->zn_topic_id_);
+
+  // No one would receive the message
+  if (is_unmatched(publisher_data)) {
+    return RMW_RET_OK;
+  }
+
+  // COPY DATA =================================================================
+  std::lock_guard<std::mutex> guard(publisher_data->serialize_mutex_);
+  const size_t data_length = serialized_message->buffer_length;
+  rmw_ret_t ret = prepare_serialize_buffer(
+    publisher_data, data_length + rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE);
+  if (ret != RMW_RET_OK) {
+    return ret;
+  }
+  rmw_zenoh_common_cpp::MessageBufferPtr & msg_buffer = publisher_data->serialize_buffer_;
+
+  std::memcpy(msg_buffer->data(), serialized_message->buffer, data_length);
+
+  // PUBLISH MESSAGE ===========================================================
+  return publish_serialized(publisher_data, msg_buffer, data_length);
 }
 
+/// PUBLISH LOANED MESSAGE =====================================================
+// Publish a message lent by rmw_borrow_loaned_message(), and take it back
+//
+// The loaned message is a plain ROS message, whose memory layout isn't CDR, so it still
+// goes through the publisher's serialization buffer. For bounded types, that buffer already fits
+// any message, so this is a single pass over the message followed by a single zn_write.
 rmw_ret_t
-rmw_publish_loaned_message(
+rmw_zenoh_common_publish_loaned_message(
   const rmw_publisher_t * publisher,
   void * ros_message,
-  rmw_publisher_allocation_t * allocation)
+  rmw_publisher_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier)
 {
-  (void)publisher;
-  (void)ros_message;
-  (void)allocation;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_publish_loaned_message");
-  return RMW_RET_UNSUPPORTED;
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_message, RMW_RET_INVALID_ARGUMENT);
+
+  if (!publisher->can_loan_messages) {
+    RMW_SET_ERROR_MSG("loaning is not supported for the type of this publisher");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  rmw_ret_t ret = rmw_zenoh_common_publish(
+    publisher, ros_message, allocation, eclipse_zenoh_identifier);
+
+  // The middleware owns the loaned message again, whether it could be published or not
+  if (ret != RMW_RET_INCORRECT_RMW_IMPLEMENTATION) {
+    static_cast<rmw_publisher_data_t *>(publisher->data)->loan_pool_->release(ros_message);
+  }
+
+  return ret;
 }
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
+
 #include "rcutils/logging_macros.h"
 #include "rcutils/strdup.h"
 
@@ -23,7 +25,14 @@
 #include "rmw/rmw.h"
 
 #include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
-
+#include "rmw_zenoh_common_cpp/rmw_init_options_impl.hpp"
+
+#include "impl/buffer_pool.hpp"
+#include "impl/dispatch_table.hpp"
+#include "impl/gid.hpp"
+#include "impl/graph_cache.hpp"
+#include "impl/message_batch.hpp"
+#include "impl/message_pool.hpp"
 #include "impl/pubsub_impl.hpp"
 #include "impl/qos.hpp"
 #include "impl/type_support_common.hpp"
@@ -32,6 +41,9 @@
 #include "rmw_zenoh_common_cpp/zenoh-net-interface.h"
 #include "rmw_zenoh_common_cpp/rmw_zenoh_common.h"
 
+// Number of loaned messages kept for reuse by each publisher
+static constexpr size_t LOANED_MESSAGES_PER_PUBLISHER = 4;
+
 /// CREATE PUBLISHER ===========================================================
 // Create and return an rmw publisher.
 rmw_publisher_t *
@@ -132,11 +144,11 @@ rmw_zenoh_common_create_publisher(
     allocator->allocate(sizeof(rmw_publisher_data_t), allocator->state));
   if (!publisher->data) {
     RMW_SET_ERROR_MSG("failed to allocate publisher data");
-    allocator->deallocate(publisher->data, allocator->state);
     allocator->deallocate(const_cast<char *>(publisher->topic_name), allocator->state);
     allocator->deallocate(publisher, allocator->state);
     return nullptr;
   }
+  new(publisher->data) rmw_publisher_data_t();
 
   publisher->options = *publisher_options;
 
@@ -182,12 +194,62 @@ rmw_zenoh_common_create_publisher(
   // Assign node pointer
   publisher_data->node_ = node;
 
-  // TODO(CH3): Put the publisher name/pointer into its corresponding node for tracking?
+  // Start with a serialization buffer that fits the smallest message of the type
+  // (Which is all of them for bounded types), followed by the publisher GID
+  publisher_data->serialize_buffer_ = node->context->impl->buffer_pool->acquire(
+    publisher_data->type_support_->getMaxSerializedSize() +
+    rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE);
+  if (!publisher_data->serialize_buffer_) {
+    RMW_SET_ERROR_MSG("failed to allocate publisher serialization buffer");
+    allocator->deallocate(publisher_data->type_support_, allocator->state);
+    publisher_data->~rmw_publisher_data_t();
+    allocator->deallocate(publisher->data, allocator->state);
 
-  // NOTE(CH3) TODO(CH3): No graph updates are implemented yet
-  // I am not sure how this will work with Zenoh
-  //
-  // Perhaps track something using the nodes?
+    allocator->deallocate(const_cast<char *>(publisher->topic_name), allocator->state);
+    allocator->deallocate(publisher, allocator->state);
+    return nullptr;
+  }
+
+  // Messages are only loaned if enabled for the context (see RMW_ZENOH_LOAN_MESSAGES), and like
+  // rmw_fastrtps, only for bounded types
+  if (node->context->options.impl->loan_messages && publisher_data->type_support_->isBounded()) {
+    publisher_data->loan_pool_ = rmw_zenoh_common_cpp::MessagePool::create(
+      type_supports, *allocator, LOANED_MESSAGES_PER_PUBLISHER);
+  }
+  publisher->can_loan_messages = publisher_data->loan_pool_ != nullptr;
+
+  // Coalesce published messages into batch frames, if enabled for the context
+  if (node->context->impl->batch_flusher) {
+    publisher_data->batch_.reset(
+      new rmw_zenoh_common_cpp::MessageBatch(
+        *node->context->impl->buffer_pool,
+        session,
+        publisher_data->zn_topic_id_,
+        publisher_data->gid_,
+        node->context->options.impl->publish_batch_size));
+    node->context->impl->batch_flusher->add(publisher_data->batch_.get());
+  }
+
+  // Track the subscriptions of the topic, and deliver to the ones of this context directly
+  publisher_data->topic_endpoints_ =
+    node->context->impl->graph_cache->get_topic_endpoint_counts(publisher->topic_name);
+  publisher_data->local_subscriptions_ =
+    node->context->impl->subscription_dispatch_table->get_fanout(publisher->topic_name);
+  publisher_data->skip_unmatched_ =
+    qos_profile->durability != RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL;
+
+  // ANNOUNCE PUBLISHER ========================================================
+  rmw_zenoh_common_cpp::generate_gid(node->context->impl->gid_prefix, publisher_data->gid_);
+
+  rmw_zenoh_common_cpp::EntityInfo entity;
+  entity.kind = rmw_zenoh_common_cpp::EntityKind::PUBLISHER;
+  memcpy(entity.gid, publisher_data->gid_, rmw_zenoh_common_cpp::GID_SIZE);
+  entity.name = publisher->topic_name;
+  entity.type = rmw_zenoh_common_cpp::create_type_name(
+    callbacks->message_namespace_, callbacks->message_name_);
+  entity.node_name = node->name;
+  entity.node_namespace = node->namespace_;
+  node->context->impl->graph_cache->add_local_entity(entity);
 
   return publisher;
 }
@@ -222,9 +284,25 @@ rmw_zenoh_common_destroy_publisher(
   rcutils_allocator_t * allocator = &node->context->options.allocator;
 
   // CLEANUP ===================================================================
-  allocator->deallocate(
-    static_cast<rmw_publisher_data_t *>(publisher->data)->type_support_,
-    allocator->state);
+  auto publisher_data = static_cast<rmw_publisher_data_t *>(publisher->data);
+
+  node->context->impl->graph_cache->remove_local_entity(publisher_data->gid_);
+
+  // Write the messages still waiting in the batch frame (unless the session is already closed)
+  if (publisher_data->batch_) {
+    node->context->impl->batch_flusher->remove(publisher_data->batch_.get());
+    if (!node->context->impl->is_shutdown && !publisher_data->batch_->flush()) {
+      RCUTILS_LOG_WARN_NAMED(
+        "rmw_zenoh_common_cpp",
+        "[rmw_destroy_publisher] Failed to write batched messages for %s",
+        publisher->topic_name);
+    }
+  }
+
+  allocator->deallocate(publisher_data->type_support_, allocator->state);
+
+  // Returns the serialization buffer to the context buffer pool
+  publisher_data->~rmw_publisher_data_t();
   allocator->deallocate(publisher->data, allocator->state);
 
   allocator->deallocate(const_cast<char *>(publisher->topic_name), allocator->state);
@@ -254,35 +332,91 @@ rmw_fini_publisher_allocation(rmw_publisher_allocation_t * allocation)
   return RMW_RET_UNSUPPORTED;
 }
 
+/// BORROW LOANED MESSAGE ======================================================
+// Lend a message from the publisher's loan pool to the user, to be filled and published with
+// rmw_publish_loaned_message() (or returned with rmw_return_loaned_message_from_publisher())
 rmw_ret_t
-rmw_borrow_loaned_message(
+rmw_zenoh_common_borrow_loaned_message(
   const rmw_publisher_t * publisher,
   const rosidl_message_type_support_t * type_support,
-  void ** ros_message)
+  void ** ros_message,
+  const char * const eclipse_zenoh_identifier)
 {
-  (void)publisher;
-  (void)type_support;
-  (void)ros_message;
   RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_borrow_loaned_message");
-  return RMW_RET_UNSUPPORTED;
+
+  // ASSERTIONS ================================================================
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    eclipse_zenoh_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  if (!publisher->can_loan_messages) {
+    RMW_SET_ERROR_MSG("loaning is not supported for the type of this publisher");
+    return RMW_RET_UNSUPPORTED;
+  }
+  if (*ros_message) {
+    RMW_SET_ERROR_MSG("ros_message must be a pointer to a null pointer");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  // LEND MESSAGE ==============================================================
+  auto publisher_data = static_cast<rmw_publisher_data_t *>(publisher->data);
+
+  *ros_message = publisher_data->loan_pool_->acquire();
+  if (!*ros_message) {
+    RMW_SET_ERROR_MSG("failed to allocate loaned message");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  return RMW_RET_OK;
 }
 
+/// RETURN LOANED MESSAGE FROM PUBLISHER =======================================
+// Take back a loaned message that wasn't published
 rmw_ret_t
-rmw_return_loaned_message_from_publisher(const rmw_publisher_t * publisher, void * loaned_message)
+rmw_zenoh_common_return_loaned_message_from_publisher(
+  const rmw_publisher_t * publisher,
+  void * loaned_message,
+  const char * const eclipse_zenoh_identifier)
 {
-  (void)publisher;
-  (void)loaned_message;
   RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_return_loaned_message_from_publisher");
-  return RMW_RET_UNSUPPORTED;
+
+  // ASSERTIONS ================================================================
+  RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(loaned_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    publisher,
+    publisher->implementation_identifier,
+    eclipse_zenoh_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  if (!publisher->can_loan_messages) {
+    RMW_SET_ERROR_MSG("loaning is not supported for the type of this publisher");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  // RECYCLE MESSAGE ===========================================================
+  static_cast<rmw_publisher_data_t *>(publisher->data)->loan_pool_->release(loaned_message);
+
+  return RMW_RET_OK;
 }
 
+/// COUNT MATCHED SUBSCRIPTIONS ================================================
+// Subscriptions of the topic of the publisher, in this context and all the others
 rmw_ret_t
 rmw_publisher_count_matched_subscriptions(const rmw_publisher_t * publisher, size_t * count)
 {
   RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_publisher_count_matched_subscriptions");
   RMW_CHECK_ARGUMENT_FOR_NULL(publisher, RMW_RET_INVALID_ARGUMENT);
   RMW_CHECK_ARGUMENT_FOR_NULL(count, RMW_RET_INVALID_ARGUMENT);
-  return RMW_RET_UNSUPPORTED;
+
+  auto publisher_data = static_cast<rmw_publisher_data_t *>(publisher->data);
+  *count = publisher_data->topic_endpoints_->subscriptions.load();
+  return RMW_RET_OK;
 }
 
 rmw_ret_t
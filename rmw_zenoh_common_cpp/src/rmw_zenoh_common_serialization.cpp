@@ -12,45 +12,204 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <fastcdr/FastBuffer.h>
+#include <fastcdr/Cdr.h>
+#include <fastcdr/exceptions/NotEnoughMemoryException.h>
+
 #include "rcutils/logging_macros.h"
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
+#include "rmw/serialized_message.h"
+
+#include "impl/type_support_common.hpp"
+
+namespace
+{
+// Get the Zenoh (C or C++) message type support callbacks out of a type support handle
+const message_type_support_callbacks_t *
+get_callbacks(const rosidl_message_type_support_t * type_supports)
+{
+  const rosidl_message_type_support_t * type_support = get_message_typesupport_handle(
+    type_supports, RMW_ZENOH_CPP_TYPESUPPORT_C);
 
+  if (!type_support) {
+    type_support = get_message_typesupport_handle(type_supports, RMW_ZENOH_CPP_TYPESUPPORT_CPP);
+    if (!type_support) {
+      RMW_SET_ERROR_MSG("type support not from this implementation");
+      return nullptr;
+    }
+  }
+
+  return static_cast<const message_type_support_callbacks_t *>(type_support->data);
+}
+
+// Serialize ros_message into the current buffer of serialized_message
+//
+// Returns false (with the buffer length left untouched) if the buffer is too small.
+bool
+serialize_into(
+  const rmw_zenoh_common_cpp::MessageTypeSupport & type_support,
+  const message_type_support_callbacks_t * callbacks,
+  const void * ros_message,
+  rmw_serialized_message_t * serialized_message,
+  bool * serialized)
+{
+  eprosima::fastcdr::FastBuffer fastbuffer(
+    reinterpret_cast<char *>(serialized_message->buffer),
+    serialized_message->buffer_capacity);
+
+  eprosima::fastcdr::Cdr ser(
+    fastbuffer,
+    eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+    eprosima::fastcdr::Cdr::DDS_CDR);
+
+  try {
+    *serialized = type_support.serializeROSmessage(ros_message, ser, callbacks);
+  } catch (const eprosima::fastcdr::exception::NotEnoughMemoryException &) {
+    return false;
+  }
+
+  if (*serialized) {
+    serialized_message->buffer_length = ser.getSerializedDataLength();
+  }
+  return true;
+}
+}  // namespace
+
+/// GET SERIALIZED MESSAGE SIZE ================================================
+// Get the largest serialized size of the messages of a type
+//
+// Only bounded types are supported, since the message bounds can't be used to compute the size of
+// the others.
 rmw_ret_t
 rmw_get_serialized_message_size(
   const rosidl_message_type_support_t * type_support,
   const rosidl_runtime_c__Sequence__bound * message_bounds,
   size_t * size)
 {
-  (void)type_support;
   (void)message_bounds;
-  (void)size;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_get_serialized_message_size");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_get_serialized_message_size");
+
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(size, RMW_RET_INVALID_ARGUMENT);
+
+  const message_type_support_callbacks_t * callbacks = get_callbacks(type_support);
+  if (!callbacks) {
+    return RMW_RET_ERROR;  // Error message already set
+  }
+
+  rmw_zenoh_common_cpp::MessageTypeSupport tss(callbacks);
+  if (!tss.isBounded()) {
+    RMW_SET_ERROR_MSG("serialized size of unbounded message types is not supported");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  *size = tss.getMaxSerializedSize();
+  return RMW_RET_OK;
 }
 
+/// SERIALIZE ==================================================================
+// Serialize a ROS message into a serialized message
+//
+// The serialized message buffer is reused when it is big enough. Bounded types are serialized in
+// a single pass, after making sure the buffer can hold their max serialized size. Unbounded types
+// are first serialized into the buffer as it is, and only sized (and serialized again) if that
+// didn't fit.
 rmw_ret_t
 rmw_serialize(
   const void * ros_message,
   const rosidl_message_type_support_t * type_support,
   rmw_serialized_message_t * serialized_message)
 {
-  (void)ros_message;
-  (void)type_support;
-  (void)serialized_message;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_serialize");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_serialize");
+
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(serialized_message, RMW_RET_INVALID_ARGUMENT);
+
+  const message_type_support_callbacks_t * callbacks = get_callbacks(type_support);
+  if (!callbacks) {
+    return RMW_RET_ERROR;  // Error message already set
+  }
+
+  rmw_zenoh_common_cpp::MessageTypeSupport tss(callbacks);
+  bool serialized = false;
+
+  // TRY THE CURRENT BUFFER ====================================================
+  if (!tss.isBounded() && serialized_message->buffer_capacity > 0 &&
+    serialize_into(tss, callbacks, ros_message, serialized_message, &serialized))
+  {
+    if (!serialized) {
+      RMW_SET_ERROR_MSG("could not serialize ROS message");
+      return RMW_RET_ERROR;
+    }
+    return RMW_RET_OK;
+  }
+
+  // SIZE THE BUFFER ===========================================================
+  // (Doesn't walk the message for bounded types)
+  size_t data_length = tss.getEstimatedSerializedSize(ros_message);
+
+  if (serialized_message->buffer_capacity < data_length) {
+    rmw_ret_t ret = rmw_serialized_message_resize(serialized_message, data_length);
+    if (ret != RMW_RET_OK) {
+      return ret;  // Error message already set
+    }
+  }
+
+  // SERIALIZE =================================================================
+  if (!serialize_into(tss, callbacks, ros_message, serialized_message, &serialized)) {
+    RMW_SET_ERROR_MSG("serialized message buffer too small for ROS message");
+    return RMW_RET_ERROR;
+  }
+  if (!serialized) {
+    RMW_SET_ERROR_MSG("could not serialize ROS message");
+    return RMW_RET_ERROR;
+  }
+
+  return RMW_RET_OK;
 }
 
+/// DESERIALIZE ================================================================
+// Deserialize a serialized message into a ROS message
 rmw_ret_t
 rmw_deserialize(
   const rmw_serialized_message_t * serialized_message,
   const rosidl_message_type_support_t * type_support,
   void * ros_message)
 {
-  (void)serialized_message;
-  (void)type_support;
-  (void)ros_message;
-  RCUTILS_LOG_INFO_NAMED("rmw_zenoh_common_cpp", "rmw_deserialize");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_deserialize");
+
+  RMW_CHECK_ARGUMENT_FOR_NULL(serialized_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(type_support, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(ros_message, RMW_RET_INVALID_ARGUMENT);
+
+  const message_type_support_callbacks_t * callbacks = get_callbacks(type_support);
+  if (!callbacks) {
+    return RMW_RET_ERROR;  // Error message already set
+  }
+
+  rmw_zenoh_common_cpp::MessageTypeSupport tss(callbacks);
+
+  // The serialized bytes are only read from
+  eprosima::fastcdr::FastBuffer fastbuffer(
+    reinterpret_cast<char *>(serialized_message->buffer),
+    serialized_message->buffer_length);
+
+  eprosima::fastcdr::Cdr deser(
+    fastbuffer,
+    eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+    eprosima::fastcdr::Cdr::DDS_CDR);
+
+  try {
+    if (!tss.deserializeROSmessage(deser, ros_message, callbacks)) {
+      RMW_SET_ERROR_MSG("could not deserialize ROS message");
+      return RMW_RET_ERROR;
+    }
+  } catch (const eprosima::fastcdr::exception::NotEnoughMemoryException &) {
+    RMW_SET_ERROR_MSG("serialized message is truncated");
+    return RMW_RET_ERROR;
+  }
+
+  return RMW_RET_OK;
 }
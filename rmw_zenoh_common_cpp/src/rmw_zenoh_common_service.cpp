@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rcutils/logging_macros.h"
@@ -27,10 +28,21 @@
 #include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
 #include "rmw_zenoh_common_cpp/rmw_zenoh_common.h"
 
+#include "impl/buffer_pool.hpp"
+#include "impl/dispatch_table.hpp"
+#include "impl/gid.hpp"
+#include "impl/graph_cache.hpp"
 #include "impl/type_support_common.hpp"
 #include "impl/service_impl.hpp"
 #include "impl/client_impl.hpp"
 
+// Length of the metadata trailer of requests: the client GID, then the sequence ID
+static constexpr size_t REQUEST_META_LENGTH =
+  rmw_zenoh_common_cpp::GID_SIZE + sizeof(std::int64_t);
+
+// Request queue depth (per client lane) of services that leave it to the middleware
+static constexpr size_t DEFAULT_SERVICE_QUEUE_DEPTH = 10;
+
 /// CREATE SERVICE SERVER ======================================================
 // Create and return an rmw service server
 rmw_service_t *
@@ -140,6 +152,7 @@ rmw_zenoh_common_create_service(
     *allocator);
   if (!service_data->zn_request_topic_key_) {
     RMW_SET_ERROR_MSG("failed to allocate zenoh request topic key");
+    service_data->~rmw_service_data_t();
     allocator->deallocate(service->data, allocator->state);
 
     allocator->deallocate(const_cast<char *>(service->service_name), allocator->state);
@@ -155,6 +168,7 @@ rmw_zenoh_common_create_service(
     allocator->deallocate(
       const_cast<char *>(service_data->zn_request_topic_key_),
       allocator->state);
+    service_data->~rmw_service_data_t();
     allocator->deallocate(service->data, allocator->state);
 
     allocator->deallocate(const_cast<char *>(service->service_name), allocator->state);
@@ -162,14 +176,6 @@ rmw_zenoh_common_create_service(
     return nullptr;
   }
 
-  // The topic ID must be unique within a single process, but separate processes can reuse IDs,
-  // even in the same Zenoh network, because the ID is never transmitted over the wire.
-  // Conversely, the ID used in two communicating processes cannot be used to determine if they are
-  // using the same topic or not.
-  service_data->zn_response_topic_id_ = zn_declare_resource(
-    session,
-    zn_rname(service_data->zn_response_topic_key_));
-
   // INSERT TYPE SUPPORT =======================================================
   // Init type support callbacks
   auto service_members = static_cast<const service_type_support_callbacks_t *>(type_support->data);
@@ -197,6 +203,7 @@ rmw_zenoh_common_create_service(
     allocator->deallocate(
       const_cast<char *>(service_data->zn_response_topic_key_),
       allocator->state);
+    service_data->~rmw_service_data_t();
     allocator->deallocate(service->data, allocator->state);
 
     allocator->deallocate(const_cast<char *>(service->service_name), allocator->state);
@@ -219,6 +226,7 @@ rmw_zenoh_common_create_service(
       const_cast<char *>(service_data->zn_response_topic_key_),
       allocator->state);
     allocator->deallocate(service_data->request_type_support_, allocator->state);
+    service_data->~rmw_service_data_t();
     allocator->deallocate(service->data, allocator->state);
 
     allocator->deallocate(const_cast<char *>(service->service_name), allocator->state);
@@ -235,73 +243,34 @@ rmw_zenoh_common_create_service(
     rmw_service_data_t::service_id_counter.fetch_add(1, std::memory_order_relaxed);
 
   // Configure request message queue
-  service_data->queue_depth_ = qos_profile->depth;
-
-  // ADD SERVICE DATA TO TOPIC MAP =============================================
-  // This will allow us to access the service data structs for this Zenoh topic key expression
-  std::string key(service_data->zn_request_topic_key_);
-  auto map_iter = rmw_service_data_t::zn_topic_to_service_data.find(key);
-
-  if (map_iter == rmw_service_data_t::zn_topic_to_service_data.end()) {
-    RCUTILS_LOG_DEBUG_NAMED(
-      "rmw_zenoh_common_cpp",
-      "[rmw_create_service] New request topic detected: %s",
-      service_data->zn_request_topic_key_);
-
-    // If no elements for this Zenoh topic key expression exists, add it in
-    std::vector<rmw_service_data_t *> service_data_vec{service_data};
-    rmw_service_data_t::zn_topic_to_service_data[key] = service_data_vec;
-
-    // We initialise subscribers ONCE (otherwise we'll get duplicate messages)
-    // The topic name will be the same for any duplicate subscribers, so it is ok
-    service_data->zn_request_subscriber_ = zn_declare_subscriber(
-      service_data->zn_session_,
-      zn_rname(service_data->zn_request_topic_key_),
-      zn_subinfo_default(),  // NOTE(CH3): Default for now
-      service_data->zn_request_sub_callback,
-      nullptr);
-
-    RCUTILS_LOG_DEBUG_NAMED(
-      "rmw_zenoh_common_cpp",
-      "[rmw_create_service] Zenoh subscriber declared for %s",
-      service_data->zn_request_topic_key_);
-  } else {
-    // Otherwise, append to the vector
-    map_iter->second.push_back(service_data);
+  // (Its capacity is fixed, so a KEEP_ALL history is also bounded by the depth)
+  service_data->queue_depth_ =
+    qos_profile->depth > 0 ? qos_profile->depth : DEFAULT_SERVICE_QUEUE_DEPTH;
+  service_data->zn_request_message_queue_.reset(
+    new rmw_zenoh_common_cpp::RequestQueue(service_data->queue_depth_));
+
+  // Assign globally unique ID, and the key that load balancing clients address requests to
+  rmw_zenoh_common_cpp::generate_gid(node->context->impl->gid_prefix, service_data->gid_);
+  service_data->zn_direct_request_topic_key_ =
+    zn_topic_key + "/request/" + rmw_zenoh_common_cpp::gid_to_string(service_data->gid_);
+
+  // ADD SERVICE DATA TO DISPATCH TABLE ========================================
+  // This routes the requests received on this Zenoh topic key expression to the service
+  // (The Zenoh subscriber is declared for the first service on the topic)
+  bool added = node->context->impl->service_dispatch_table->add(
+    session, service_data->zn_request_topic_key_, service_data);
+
+  // Requests addressed to this service only
+  if (added && !node->context->impl->service_dispatch_table->add(
+      session, service_data->zn_direct_request_topic_key_, service_data))
+  {
+    node->context->impl->service_dispatch_table->remove(
+      service_data->zn_request_topic_key_, service_data);
+    added = false;
   }
 
-  RCUTILS_LOG_DEBUG_NAMED(
-    "rmw_zenoh_common_cpp",
-    "[rmw_create_service] Service for %s (ID: %ld) added to topic map",
-    service->service_name,
-    service_data->service_id_);
-
-  // DECLARE SERVICE IS AVAILABLE ==============================================
-  service_data->zn_queryable_ = zn_declare_queryable(
-    session,
-    zn_rname(service->service_name),
-    ZN_QUERYABLE_STORAGE,
-    rmw_service_data_t::zn_service_availability_queryable_callback,
-    nullptr);
-
-  if (service_data->zn_queryable_ == 0) {
-    RMW_SET_ERROR_MSG("failed to create availability queryable for service");
-
-    // Delete the service data pointer in the Zenoh topic to service data map
-    for (auto it = map_iter->second.begin(); it != map_iter->second.end(); ++it) {
-      if ((*it)->service_id_ == service_data->service_id_) {
-        map_iter->second.erase(it);
-        break;
-      }
-    }
-
-    // Delete the map element if no other client data pointers exist
-    // (That is, when no other services are listening to the Zenoh request topic)
-    if (map_iter->second.empty()) {
-      zn_undeclare_subscriber(service_data->zn_request_subscriber_);
-      rmw_service_data_t::zn_topic_to_service_data.erase(map_iter);
-    }
-
+  if (!added) {
+    RMW_SET_ERROR_MSG("failed to declare Zenoh request subscriber for service");
     allocator->deallocate(
       const_cast<char *>(service_data->zn_request_topic_key_),
       allocator->state);
@@ -310,6 +279,7 @@ rmw_zenoh_common_create_service(
       allocator->state);
     allocator->deallocate(service_data->request_type_support_, allocator->state);
     allocator->deallocate(service_data->response_type_support_, allocator->state);
+    service_data->~rmw_service_data_t();
     allocator->deallocate(service->data, allocator->state);
 
     allocator->deallocate(const_cast<char *>(service->service_name), allocator->state);
@@ -317,6 +287,24 @@ rmw_zenoh_common_create_service(
     return nullptr;
   }
 
+  RCUTILS_LOG_DEBUG_NAMED(
+    "rmw_zenoh_common_cpp",
+    "[rmw_create_service] Service for %s (ID: %ld) added to dispatch table",
+    service->service_name,
+    service_data->service_id_);
+
+  // ANNOUNCE SERVICE ==========================================================
+  // Clients in this context and the others now see the service as available
+  rmw_zenoh_common_cpp::EntityInfo entity;
+  entity.kind = rmw_zenoh_common_cpp::EntityKind::SERVICE;
+  memcpy(entity.gid, service_data->gid_, rmw_zenoh_common_cpp::GID_SIZE);
+  entity.name = service->service_name;
+  entity.type = rmw_zenoh_common_cpp::create_type_name(
+    service_members->service_namespace_, service_members->service_name_);
+  entity.node_name = node->name;
+  entity.node_namespace = node->namespace_;
+  node->context->impl->graph_cache->add_local_entity(entity);
+
   return service;
 }
 
@@ -352,58 +340,37 @@ rmw_zenoh_common_destroy_service(
   // OBTAIN SERVICE MEMBERS ====================================================
   auto * service_data = static_cast<rmw_service_data_t *>(service->data);
 
-  // DELETE SERVICE DATA IN TOPIC MAP ==========================================
-  std::string key(service_data->zn_request_topic_key_);
-  auto map_iter = rmw_service_data_t::zn_topic_to_service_data.find(key);
+  // RETRACT SERVICE ===========================================================
+  node->context->impl->graph_cache->remove_local_entity(service_data->gid_);
 
-  if (map_iter == rmw_service_data_t::zn_topic_to_service_data.end()) {
+  // DELETE SERVICE DATA IN DISPATCH TABLE =====================================
+  // Only when there are no more active RMW services listening to this Zenoh topic, is the
+  // subscriber undeclared on Zenoh's end (which means no more Zenoh callbacks will trigger on
+  // this topic)
+  if (!node->context->impl->service_dispatch_table->remove(
+      service_data->zn_request_topic_key_, service_data))
+  {
     RCUTILS_LOG_WARN_NAMED(
       "rmw_zenoh_common_cpp",
-      "service not found in Zenoh topic to service data map! %s",
+      "service not found in Zenoh topic dispatch table! %s",
       service_data->zn_request_topic_key_);
   } else {
-    // Delete the subscription data pointer in the Zenoh topic to service data map
-    for (auto it = map_iter->second.begin(); it != map_iter->second.end(); ++it) {
-      if ((*it)->service_id_ == service_data->service_id_) {
-        map_iter->second.erase(it);
-        break;
-      }
-    }
-
-    // Delete the map element if no other service data pointers exist
-    // (That is, when no other services are listening to the Zenoh topic)
-    if (map_iter->second.empty()) {
-      RCUTILS_LOG_DEBUG_NAMED(
-        "rmw_zenoh_common_cpp",
-        "[rmw_destroy_service] No more services listening to %s",
-        service_data->zn_request_topic_key_);
-
-      // Only when there are no more active RMW services listening to this Zenoh topic, do we
-      // undeclare the subscriber on Zenoh's end (which means no more Zenoh callbacks will trigger
-      // on this topic)
-      zn_undeclare_subscriber(service_data->zn_request_subscriber_);
-      RCUTILS_LOG_DEBUG_NAMED(
-        "rmw_zenoh_common_cpp",
-        "[rmw_destroy_service] Zenoh subcriber undeclared for %s",
-        service_data->zn_request_topic_key_);
-
-      rmw_service_data_t::zn_topic_to_service_data.erase(map_iter);
-    }
-
     RCUTILS_LOG_DEBUG_NAMED(
       "rmw_zenoh_common_cpp",
-      "[rmw_destroy_service] Service for %s (ID: %ld) removed from topic map",
+      "[rmw_destroy_service] Service for %s (ID: %ld) removed from dispatch table",
       service_data->zn_request_topic_key_,
       service_data->service_id_);
   }
+  node->context->impl->service_dispatch_table->remove(
+    service_data->zn_direct_request_topic_key_, service_data);
 
   // CLEANUP ===================================================================
-  zn_undeclare_queryable(service_data->zn_queryable_);
-
   allocator->deallocate(const_cast<char *>(service_data->zn_request_topic_key_), allocator->state);
   allocator->deallocate(const_cast<char *>(service_data->zn_response_topic_key_), allocator->state);
   allocator->deallocate(service_data->request_type_support_, allocator->state);
   allocator->deallocate(service_data->response_type_support_, allocator->state);
+  // Returns the buffers still queued to the context buffer pool
+  service_data->~rmw_service_data_t();
   allocator->deallocate(service->data, allocator->state);
 
   allocator->deallocate(const_cast<char *>(service->service_name), allocator->state);
@@ -444,13 +411,10 @@ rmw_zenoh_common_take_request(
   // OBTAIN SERVICE MEMBERS ====================================================
   auto * service_data = static_cast<rmw_service_data_t *>(service->data);
 
-  // OBTAIN ALLOCATOR ==========================================================
-  rcutils_allocator_t * allocator = &service_data->node_->context->options.allocator;
-
   // RETRIEVE SERIALIZED MESSAGE ===============================================
-  std::unique_lock<std::mutex> lock(service_data->request_queue_mutex_);
-
-  if (service_data->zn_request_message_queue_.empty()) {
+  // The queue is lock-free, so executor threads can take requests concurrently
+  rmw_zenoh_common_cpp::MessageBufferPtr request_bytes_ptr;
+  if (!service_data->zn_request_message_queue_->try_pop(request_bytes_ptr)) {
     // NOTE(CH3): It is correct to be returning RMW_RET_OK. The information that the message
     // was not found is encoded in the fact that the taken-out parameter is still False.
     //
@@ -458,12 +422,6 @@ rmw_zenoh_common_take_request(
     return RMW_RET_OK;
   }
 
-  // NOTE(CH3): Potential place to handle "QoS" (e.g. could pop from back so it is LIFO)
-  auto request_bytes_ptr = service_data->zn_request_message_queue_.back();
-  service_data->zn_request_message_queue_.pop_back();
-
-  service_data->request_queue_mutex_.unlock();
-
   RCUTILS_LOG_DEBUG_NAMED(
     "rmw_zenoh_common_cpp",
     "[rmw_take] Request found: %s",
@@ -473,24 +431,29 @@ rmw_zenoh_common_take_request(
   //
   // TODO(CH3): Refactor this into its own modular set of functions eventually to make adding
   // more metadata convenient
-  size_t meta_length = sizeof(std::int64_t);  // Internal type of the atomic sequence ID
+  if (request_bytes_ptr->size() < REQUEST_META_LENGTH) {
+    RMW_SET_ERROR_MSG("request message is missing its metadata");
+    return RMW_RET_ERROR;
+  }
+  size_t data_length = request_bytes_ptr->size() - REQUEST_META_LENGTH;
 
   // Use metadata
+  // (The client GID is handed back in rmw_send_response(), to address the response to the client)
+  memcpy(
+    request_header->request_id.writer_guid,
+    request_bytes_ptr->data() + data_length,
+    rmw_zenoh_common_cpp::GID_SIZE);
   memcpy(
     &request_header->request_id.sequence_number,
-    &request_bytes_ptr->back() + 1 - meta_length,
-    meta_length);
+    request_bytes_ptr->data() + data_length + rmw_zenoh_common_cpp::GID_SIZE,
+    sizeof(std::int64_t));
 
   // DESERIALIZE MESSAGE =======================================================
-  size_t data_length = request_bytes_ptr->size() - meta_length;
 
-  unsigned char * cdr_buffer = static_cast<unsigned char *>(allocator->allocate(
-      data_length,
-      allocator->state));
-  memcpy(cdr_buffer, &request_bytes_ptr->front(), data_length);
-
-  // Object that manages the raw buffer.
-  eprosima::fastcdr::FastBuffer fastbuffer(reinterpret_cast<char *>(cdr_buffer), data_length);
+  // The queued request bytes are deserialized in place (the metadata trailer is just ignored)
+  eprosima::fastcdr::FastBuffer fastbuffer(
+    reinterpret_cast<char *>(request_bytes_ptr->data()),
+    data_length);
 
   // Object that deserializes the data
   eprosima::fastcdr::Cdr deser(
@@ -507,13 +470,15 @@ rmw_zenoh_common_take_request(
   }
 
   *taken = true;
-  allocator->deallocate(cdr_buffer, allocator->state);
 
   return RMW_RET_OK;
 }
 
 /// SEND SERVICE RESPONSE ======================================================
 // Serialize and publish a ROS response message using Zenoh.
+//
+// The response is only sent to the client that made the request, on its own response key
+// (<service>/response/<client GID>, the GID coming from the request metadata).
 rmw_ret_t
 rmw_zenoh_common_send_response(
   const rmw_service_t * service,
@@ -522,9 +487,8 @@ rmw_zenoh_common_send_response(
   const char * const eclipse_zenoh_identifier)
 {
   RCUTILS_LOG_DEBUG_NAMED(
-    "rmw_zenoh_common_cpp", "[rmw_send_response] %s (%ld)",
-    static_cast<rmw_service_data_t *>(service->data)->zn_response_topic_key_,
-    static_cast<rmw_service_data_t *>(service->data)->zn_response_topic_id_);
+    "rmw_zenoh_common_cpp", "[rmw_send_response] %s",
+    static_cast<rmw_service_data_t *>(service->data)->zn_response_topic_key_);
 
   // ASSERTIONS ================================================================
   RMW_CHECK_ARGUMENT_FOR_NULL(service, RMW_RET_INVALID_ARGUMENT);
@@ -545,10 +509,6 @@ rmw_zenoh_common_send_response(
   // OBTAIN SERVICE MEMBERS ====================================================
   auto * service_data = static_cast<rmw_service_data_t *>(service->data);
 
-  // ASSIGN ALLOCATOR ==========================================================
-  rcutils_allocator_t * allocator =
-    &(static_cast<rmw_service_data_t *>(service->data)->node_->context->options.allocator);
-
   // SERIALIZE DATA ============================================================
   size_t max_data_length = (
     static_cast<rmw_service_data_t *>(service->data)
@@ -558,14 +518,14 @@ rmw_zenoh_common_send_response(
   max_data_length += sizeof(request_header->sequence_number);
 
   // Init serialized message byte array
-  char * response_bytes = static_cast<char *>(allocator->allocate(
-      max_data_length,
-      allocator->state));
-  if (!response_bytes) {
+  // (Returned to the context buffer pool when response_buffer goes out of scope)
+  rmw_zenoh_common_cpp::MessageBufferPtr response_buffer =
+    service_data->node_->context->impl->buffer_pool->acquire(max_data_length);
+  if (!response_buffer) {
     RMW_SET_ERROR_MSG("failed allocate response message bytes");
-    allocator->deallocate(response_bytes, allocator->state);
     return RMW_RET_ERROR;
   }
+  char * response_bytes = reinterpret_cast<char *>(response_buffer->data());
 
   // Object that manages the raw buffer
   eprosima::fastcdr::FastBuffer fastbuffer(response_bytes, max_data_length);
@@ -580,7 +540,6 @@ rmw_zenoh_common_send_response(
       ser,
       service_data->response_type_support_impl_))
   {
-    allocator->deallocate(response_bytes, allocator->state);
     return RMW_RET_ERROR;
   }
 
@@ -595,14 +554,17 @@ rmw_zenoh_common_send_response(
     meta_length);
 
   // PUBLISH ON ZENOH MIDDLEWARE LAYER =========================================
+  std::string client_response_key(service_data->zn_response_topic_key_);
+  client_response_key += '/';
+  client_response_key += rmw_zenoh_common_cpp::gid_to_string(
+    reinterpret_cast<const uint8_t *>(request_header->writer_guid));
+
   size_t wrid_ret = zn_write(
     service_data->zn_session_,
-    zn_rid(service_data->zn_response_topic_id_),
+    zn_rname(client_response_key.c_str()),
     response_bytes,
     data_length + meta_length);
 
-  allocator->deallocate(response_bytes, allocator->state);
-
   if (wrid_ret == 0) {
     return RMW_RET_OK;
   } else {
@@ -12,8 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
 #include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rcutils/logging_macros.h"
@@ -25,9 +27,15 @@
 #include "rmw/error_handling.h"
 #include "rmw/event.h"
 #include "rmw/rmw.h"
+#include "rmw/serialized_message.h"
 
 #include "rmw_zenoh_common_cpp/rmw_context_impl.hpp"
+#include "rmw_zenoh_common_cpp/rmw_init_options_impl.hpp"
 
+#include "impl/dispatch_table.hpp"
+#include "impl/gid.hpp"
+#include "impl/graph_cache.hpp"
+#include "impl/message_pool.hpp"
 #include "impl/pubsub_impl.hpp"
 #include "impl/qos.hpp"
 #include "impl/type_support_common.hpp"
@@ -36,6 +44,70 @@
 #include "rmw_zenoh_common_cpp/rmw_zenoh_common.h"
 #include "rmw_zenoh_common_cpp/zenoh-net-interface.h"
 
+// Message queue depth of subscriptions that leave it to the middleware
+static constexpr size_t DEFAULT_SUBSCRIPTION_QUEUE_DEPTH = 10;
+
+// Number of loaned messages kept for reuse by each subscription
+static constexpr size_t LOANED_MESSAGES_PER_SUBSCRIPTION = 4;
+
+// Length of the CDR bytes of queued message bytes (which are followed by the publisher GID)
+static size_t
+message_length(const rmw_zenoh_common_cpp::MessageBufferPtr & msg_bytes_ptr)
+{
+  return msg_bytes_ptr->size() - rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE;
+}
+
+// Fill the message info of queued message bytes
+//
+// Messages from publishers of the same context (i.e. the same GID prefix) are the ones they handed
+// to the subscription directly, so they are reported as intra-process.
+// Samples don't carry timestamps, so those are left at 0.
+static void
+fill_message_info(
+  const rmw_subscription_t * subscription,
+  const rmw_zenoh_common_cpp::MessageBufferPtr & msg_bytes_ptr,
+  rmw_message_info_t * message_info)
+{
+  message_info->source_timestamp = 0;
+  message_info->received_timestamp = 0;
+  message_info->publisher_gid.implementation_identifier = subscription->implementation_identifier;
+  memset(message_info->publisher_gid.data, 0, RMW_GID_STORAGE_SIZE);
+  memcpy(
+    message_info->publisher_gid.data,
+    msg_bytes_ptr->data() + message_length(msg_bytes_ptr),
+    rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE);
+  auto * subscription_data = static_cast<const rmw_subscription_data_t *>(subscription->data);
+  message_info->from_intra_process = memcmp(
+    message_info->publisher_gid.data,
+    subscription_data->node_->context->impl->gid_prefix,
+    rmw_zenoh_common_cpp::GID_PREFIX_SIZE) == 0;
+}
+
+// Deserialize queued message bytes into a ROS message
+//
+// The bytes are only read from, so they can be shared with the other subscriptions the message was
+// delivered to.
+static bool
+deserialize_message(
+  const rmw_subscription_data_t * subscription_data,
+  const rmw_zenoh_common_cpp::MessageBufferPtr & msg_bytes_ptr,
+  void * ros_message)
+{
+  eprosima::fastcdr::FastBuffer fastbuffer(
+    reinterpret_cast<char *>(msg_bytes_ptr->data()),
+    message_length(msg_bytes_ptr));
+
+  eprosima::fastcdr::Cdr deser(
+    fastbuffer,
+    eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
+    eprosima::fastcdr::Cdr::DDS_CDR);
+
+  return subscription_data->type_support_->deserializeROSmessage(
+    deser,
+    ros_message,
+    subscription_data->type_support_impl_);
+}
+
 /// CREATE SUBSCRIPTION ========================================================
 // Create and return an rmw subscriber
 rmw_subscription_t *
@@ -128,7 +200,6 @@ rmw_zenoh_common_create_subscription(
   // Populate common members
   subscription->implementation_identifier = eclipse_zenoh_identifier;  // const char * assignment
   subscription->options = *subscription_options;
-  subscription->can_loan_messages = false;
 
   subscription->topic_name = rcutils_strdup(topic_name, *allocator);
   if (!subscription->topic_name) {
@@ -167,6 +238,7 @@ rmw_zenoh_common_create_subscription(
   new(subscription_data->type_support_) rmw_zenoh_common_cpp::MessageTypeSupport(callbacks);
   if (!subscription_data->type_support_) {
     RMW_SET_ERROR_MSG("failed to allocate MessageTypeSupport");
+    subscription_data->~rmw_subscription_data_t();
     allocator->deallocate(subscription->data, allocator->state);
 
     allocator->deallocate(const_cast<char *>(subscription->topic_name), allocator->state);
@@ -182,53 +254,60 @@ rmw_zenoh_common_create_subscription(
     rmw_subscription_data_t::subscription_id_counter.fetch_add(1, std::memory_order_relaxed);
 
   // Configure message queue
-  subscription_data->queue_depth_ = qos_profile->depth;
-
-  // ADD SUBSCRIPTION DATA TO TOPIC MAP ========================================
-  // This will allow us to access the subscription data structs for this Zenoh topic key expression
-  std::string key(subscription->topic_name);
-  auto map_iter = rmw_subscription_data_t::zn_topic_to_sub_data.find(key);
+  // (Its capacity is fixed, so a KEEP_ALL history is also bounded by the depth)
+  subscription_data->queue_depth_ =
+    qos_profile->depth > 0 ? qos_profile->depth : DEFAULT_SUBSCRIPTION_QUEUE_DEPTH;
+  subscription_data->zn_message_queue_.reset(
+    new rmw_subscription_data_t::MessageQueue(subscription_data->queue_depth_));
+
+  // Messages are only loaned if enabled for the context (see RMW_ZENOH_LOAN_MESSAGES), and like
+  // rmw_fastrtps, only for bounded types
+  if (node->context->options.impl->loan_messages &&
+    subscription_data->type_support_->isBounded())
+  {
+    subscription_data->loan_pool_ = rmw_zenoh_common_cpp::MessagePool::create(
+      type_supports, *allocator, LOANED_MESSAGES_PER_SUBSCRIPTION);
+  }
+  subscription->can_loan_messages = subscription_data->loan_pool_ != nullptr;
 
-  if (map_iter == rmw_subscription_data_t::zn_topic_to_sub_data.end()) {
-    RCUTILS_LOG_DEBUG_NAMED(
-      "rmw_zenoh_common_cpp",
-      "[rmw_create_subscription] New topic detected: %s",
-      topic_name);
-
-    // If no elements for this Zenoh topic key expression exists, add it in
-    std::vector<rmw_subscription_data_t *> sub_data_vec{subscription_data};
-    rmw_subscription_data_t::zn_topic_to_sub_data[key] = sub_data_vec;
-
-    // We initialise subscribers ONCE (otherwise we'll get duplicate messages)
-    // The topic name will be the same for any duplicate subscribers, so it is ok
-    subscription_data->zn_subscriber_ = zn_declare_subscriber(
-      subscription_data->zn_session_,
-      zn_rname(subscription->topic_name),
-      zn_subinfo_default(),  // NOTE(CH3): Default for now
-      subscription_data->zn_sub_callback,
-      nullptr);
+  // ADD SUBSCRIPTION DATA TO DISPATCH TABLE ===================================
+  // This routes the samples received on this Zenoh topic key expression to the subscription
+  // (The Zenoh subscriber is declared for the first subscription on the topic)
+  if (!node->context->impl->subscription_dispatch_table->add(
+      session, subscription->topic_name, subscription_data))
+  {
+    RMW_SET_ERROR_MSG("failed to declare Zenoh subscriber");
+    allocator->deallocate(subscription_data->type_support_, allocator->state);
+    subscription_data->~rmw_subscription_data_t();
+    allocator->deallocate(subscription->data, allocator->state);
 
-    RCUTILS_LOG_DEBUG_NAMED(
-      "rmw_zenoh_common_cpp",
-      "[rmw_create_subscription] Zenoh subscription declared for %s",
-      topic_name);
-  } else {
-    // Otherwise, append to the vector
-    map_iter->second.push_back(subscription_data);
+    allocator->deallocate(const_cast<char *>(subscription->topic_name), allocator->state);
+    allocator->deallocate(subscription, allocator->state);
+    return nullptr;
   }
 
   RCUTILS_LOG_DEBUG_NAMED(
     "rmw_zenoh_common_cpp",
-    "[rmw_create_subscription] Subscription for %s (ID: %ld) added to topic map",
+    "[rmw_create_subscription] Subscription for %s (ID: %ld) added to dispatch table",
     topic_name,
     subscription_data->subscription_id_);
 
-  // TODO(CH3): Put the subscription name/pointer into its corresponding node for tracking?
+  // Track the publishers of the topic
+  subscription_data->topic_endpoints_ =
+    node->context->impl->graph_cache->get_topic_endpoint_counts(subscription->topic_name);
 
-  // NOTE(CH3) TODO(CH3): No graph updates are implemented yet
-  // I am not sure how this will work with Zenoh
-  //
-  // Perhaps track something using the nodes?
+  // ANNOUNCE SUBSCRIPTION =====================================================
+  rmw_zenoh_common_cpp::generate_gid(node->context->impl->gid_prefix, subscription_data->gid_);
+
+  rmw_zenoh_common_cpp::EntityInfo entity;
+  entity.kind = rmw_zenoh_common_cpp::EntityKind::SUBSCRIPTION;
+  memcpy(entity.gid, subscription_data->gid_, rmw_zenoh_common_cpp::GID_SIZE);
+  entity.name = subscription->topic_name;
+  entity.type = rmw_zenoh_common_cpp::create_type_name(
+    callbacks->message_namespace_, callbacks->message_name_);
+  entity.node_name = node->name;
+  entity.node_namespace = node->namespace_;
+  node->context->impl->graph_cache->add_local_entity(entity);
 
   return subscription;
 }
@@ -266,53 +345,32 @@ rmw_zenoh_common_destroy_subscription(
   // OBTAIN ALLOCATOR ==========================================================
   rcutils_allocator_t * allocator = &node->context->options.allocator;
 
-  // DELETE SUBSCRIPTION DATA IN TOPIC MAP =====================================
-  std::string key(subscription->topic_name);
-  auto map_iter = rmw_subscription_data_t::zn_topic_to_sub_data.find(key);
+  // RETRACT SUBSCRIPTION ======================================================
+  node->context->impl->graph_cache->remove_local_entity(subscription_data->gid_);
 
-  if (map_iter == rmw_subscription_data_t::zn_topic_to_sub_data.end()) {
+  // DELETE SUBSCRIPTION DATA IN DISPATCH TABLE ================================
+  // Only when there are no more active RMW subscriptions listening to this Zenoh topic, is the
+  // subscriber undeclared on Zenoh's end (which means no more Zenoh callbacks will trigger on
+  // this topic)
+  if (!node->context->impl->subscription_dispatch_table->remove(
+      subscription->topic_name, subscription_data))
+  {
     RCUTILS_LOG_WARN_NAMED(
       "rmw_zenoh_common_cpp",
-      "subscription not found in Zenoh topic to subscription data map! %s",
+      "subscription not found in Zenoh topic dispatch table! %s",
       subscription->topic_name);
   } else {
-    // Delete the subscription data pointer in the Zenoh topic to subscription data map
-    for (auto it = map_iter->second.begin(); it != map_iter->second.end(); ++it) {
-      if ((*it)->subscription_id_ == subscription_data->subscription_id_) {
-        map_iter->second.erase(it);
-        break;
-      }
-    }
-
-    // Delete the map element if no other subscription data pointers exist
-    // (That is, when no other subscriptions are listening to the Zenoh topic)
-    if (map_iter->second.empty()) {
-      RCUTILS_LOG_DEBUG_NAMED(
-        "rmw_zenoh_common_cpp",
-        "[rmw_destroy_subscription] No more subscriptions listening to %s",
-        subscription->topic_name);
-
-      // Only when there are no more active RMW subscriptions listening to this Zenoh topic, do we
-      // undeclare the subscriber on Zenoh's end (which means no more Zenoh callbacks will trigger
-      // on this topic)
-      zn_undeclare_subscriber(subscription_data->zn_subscriber_);
-      RCUTILS_LOG_DEBUG_NAMED(
-        "rmw_zenoh_common_cpp",
-        "[rmw_destroy_subscription] Zenoh subcriber undeclared for %s",
-        subscription->topic_name);
-
-      rmw_subscription_data_t::zn_topic_to_sub_data.erase(map_iter);
-    }
-
     RCUTILS_LOG_DEBUG_NAMED(
       "rmw_zenoh_common_cpp",
-      "[rmw_destroy_subscription] Subscription for %s (ID: %ld) removed from topic map",
+      "[rmw_destroy_subscription] Subscription for %s (ID: %ld) removed from dispatch table",
       subscription->topic_name,
       subscription_data->subscription_id_);
   }
 
   // CLEANUP ===================================================================
   allocator->deallocate(subscription_data->type_support_, allocator->state);
+  // Returns the buffers still queued to the context buffer pool
+  subscription_data->~rmw_subscription_data_t();
   allocator->deallocate(subscription->data, allocator->state);
 
   allocator->deallocate(const_cast<char *>(subscription->topic_name), allocator->state);
@@ -353,13 +411,10 @@ rmw_zenoh_common_take(
   // OBTAIN SUBSCRIPTION MEMBERS ===============================================
   auto * subscription_data = static_cast<rmw_subscription_data_t *>(subscription->data);
 
-  // OBTAIN ALLOCATOR ==========================================================
-  rcutils_allocator_t * allocator = &subscription_data->node_->context->options.allocator;
-
   // RETRIEVE SERIALIZED MESSAGE ===============================================
-  std::unique_lock<std::mutex> lock(subscription_data->message_queue_mutex_);
+  rmw_zenoh_common_cpp::MessageBufferPtr msg_bytes_ptr;
 
-  if (subscription_data->zn_message_queue_.empty()) {
+  if (!subscription_data->zn_message_queue_->try_pop(msg_bytes_ptr)) {
     // NOTE(CH3): It is correct to be returning RMW_RET_OK. The information that the message
     // was not found is encoded in the fact that the taken-out parameter is still False.
     //
@@ -367,12 +422,6 @@ rmw_zenoh_common_take(
     return RMW_RET_OK;
   }
 
-  // NOTE(CH3): Potential place to handle "QoS" (e.g. could pop from back so it is LIFO)
-  auto msg_bytes_ptr = subscription_data->zn_message_queue_.back();
-  subscription_data->zn_message_queue_.pop_back();
-
-  subscription_data->message_queue_mutex_.unlock();
-
   RCUTILS_LOG_DEBUG_NAMED(
     "rmw_zenoh_common_cpp",
     "[rmw_take] Message found: %s",
@@ -380,37 +429,18 @@ rmw_zenoh_common_take(
 
   // DESERIALIZE MESSAGE =======================================================
   //
-  // NOTE(CH3): Potential place for optimisation (Eliminate repeated copies and deserialisations)
+  // NOTE(CH3): Potential place for optimisation (Eliminate repeated deserialisations)
   //
   // If multiple subscribers are looking at this message, the message can just be deserialised
   // once.
   //
-  // But that will mean tracking the serialisation state of the message (perhaps with a pair?)
-  unsigned char * cdr_buffer = static_cast<unsigned char *>(
-    allocator->allocate(msg_bytes_ptr->size(), allocator->state));
-  memcpy(cdr_buffer, &msg_bytes_ptr->front(), msg_bytes_ptr->size());
-
-  // Object that manages the raw buffer
-  eprosima::fastcdr::FastBuffer fastbuffer(
-    reinterpret_cast<char *>(cdr_buffer),
-    msg_bytes_ptr->size());
-
-  // Object that serializes the data
-  eprosima::fastcdr::Cdr deser(
-    fastbuffer,
-    eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
-    eprosima::fastcdr::Cdr::DDS_CDR);
-  if (!subscription_data->type_support_->deserializeROSmessage(
-      deser,
-      ros_message,
-      subscription_data->type_support_impl_))
-  {
+  // But that will mean tracking the deserialisation state of the message (perhaps with a pair?)
+  if (!deserialize_message(subscription_data, msg_bytes_ptr, ros_message)) {
     RMW_SET_ERROR_MSG("could not deserialize ROS message");
     return RMW_RET_ERROR;
   }
 
   *taken = true;
-  allocator->deallocate(cdr_buffer, allocator->state);
 
   return RMW_RET_OK;
 }
@@ -418,15 +448,7 @@ rmw_zenoh_common_take(
 /// TAKE MESSAGE WITH INFO =====================================================
 // Take message out of the message queue, and obtain its message info
 //
-// TODO(CH3): By right the passed rmw_message_info_t should have its members filled, which include:
-// Source and message reception timestamps, publisher_gid, and whether the message was from
-// inside the process.
-//
-// The problem is I'm not sure how to get this data from the way we've done things...
-// So this functionality is left unimplemented for now. It doesn't seem to break pubsub.
-//
-// (More specifically, there isn't a way to send the information on the publish side using Zenoh
-// unless we include it in the raw message bytes that get sent.)
+// The publisher GID comes from the trailer publishers append to their samples (see gid.hpp).
 rmw_ret_t
 rmw_zenoh_common_take_with_info(
   const rmw_subscription_t * subscription,
@@ -459,13 +481,10 @@ rmw_zenoh_common_take_with_info(
   // OBTAIN SUBSCRIPTION MEMBERS ===============================================
   auto * subscription_data = static_cast<rmw_subscription_data_t *>(subscription->data);
 
-  // OBTAIN ALLOCATOR ==========================================================
-  rcutils_allocator_t * allocator = &subscription_data->node_->context->options.allocator;
-
   // RETRIEVE SERIALIZED MESSAGE ===============================================
-  std::unique_lock<std::mutex> lock(subscription_data->message_queue_mutex_);
+  rmw_zenoh_common_cpp::MessageBufferPtr msg_bytes_ptr;
 
-  if (subscription_data->zn_message_queue_.empty()) {
+  if (!subscription_data->zn_message_queue_->try_pop(msg_bytes_ptr)) {
     // NOTE(CH3): It is correct to be returning RMW_RET_OK. The information that the message
     // was not found is encoded in the fact that the taken-out parameter is still False.
     //
@@ -473,12 +492,6 @@ rmw_zenoh_common_take_with_info(
     return RMW_RET_OK;
   }
 
-  // NOTE(CH3): Potential place to handle "QoS" (e.g. could pop from back so it is LIFO)
-  auto msg_bytes_ptr = subscription_data->zn_message_queue_.back();
-  subscription_data->zn_message_queue_.pop_back();
-
-  subscription_data->message_queue_mutex_.unlock();
-
   RCUTILS_LOG_DEBUG_NAMED(
     "rmw_zenoh_common_cpp",
     "[rmw_take] Message found: %s",
@@ -486,42 +499,101 @@ rmw_zenoh_common_take_with_info(
 
   // DESERIALIZE MESSAGE =======================================================
   //
-  // NOTE(CH3): Potential place for optimisation (Eliminate repeated copies and deserialisations)
+  // NOTE(CH3): Potential place for optimisation (Eliminate repeated deserialisations)
   //
   // If multiple subscribers are looking at this message, the message can just be deserialised
   // once.
   //
-  // But that will mean tracking the serialisation state of the message (perhaps with a pair?)
-  unsigned char * cdr_buffer = static_cast<unsigned char *>(allocator->allocate(
-      msg_bytes_ptr->size(),
-      allocator->state));
-  memcpy(cdr_buffer, &msg_bytes_ptr->front(), msg_bytes_ptr->size());
-
-  // Object that manages the raw buffer
-  eprosima::fastcdr::FastBuffer fastbuffer(
-    reinterpret_cast<char *>(cdr_buffer),
-    msg_bytes_ptr->size());
-
-  // Object that serializes the data
-  eprosima::fastcdr::Cdr deser(
-    fastbuffer,
-    eprosima::fastcdr::Cdr::DEFAULT_ENDIAN,
-    eprosima::fastcdr::Cdr::DDS_CDR);
-  if (!subscription_data->type_support_->deserializeROSmessage(
-      deser,
-      ros_message,
-      subscription_data->type_support_impl_))
-  {
+  // But that will mean tracking the deserialisation state of the message (perhaps with a pair?)
+  if (!deserialize_message(subscription_data, msg_bytes_ptr, ros_message)) {
     RMW_SET_ERROR_MSG("could not deserialize ROS message");
     return RMW_RET_ERROR;
   }
 
+  fill_message_info(subscription, msg_bytes_ptr, message_info);
   *taken = true;
-  allocator->deallocate(cdr_buffer, allocator->state);
 
   return RMW_RET_OK;
 }
 
+/// TAKE SEQUENCE ==============================================================
+// Take up to count messages out of the message queue, in one call
+//
+// The queue is drained until count messages are taken or it runs empty, deserializing each message
+// into the next element of message_sequence. A burst of messages can then be handled with a single
+// wait and take, instead of one of each per message.
+rmw_ret_t
+rmw_zenoh_common_take_sequence(
+  const rmw_subscription_t * subscription,
+  size_t count,
+  rmw_message_sequence_t * message_sequence,
+  rmw_message_info_sequence_t * message_info_sequence,
+  size_t * taken,
+  rmw_subscription_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier)
+{
+  (void)allocation;
+
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_take_sequence");
+
+  // ASSERTIONS ================================================================
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(message_sequence, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(message_info_sequence, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(taken, RMW_RET_INVALID_ARGUMENT);
+  *taken = 0;
+
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    eclipse_zenoh_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription->data, RMW_RET_ERROR);
+
+  if (count == 0) {
+    RMW_SET_ERROR_MSG("count cannot be 0");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (count > message_sequence->capacity) {
+    RMW_SET_ERROR_MSG("insufficient capacity in message_sequence");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+  if (count > message_info_sequence->capacity) {
+    RMW_SET_ERROR_MSG("insufficient capacity in message_info_sequence");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  // OBTAIN SUBSCRIPTION MEMBERS ===============================================
+  auto * subscription_data = static_cast<rmw_subscription_data_t *>(subscription->data);
+
+  // DRAIN MESSAGE QUEUE =======================================================
+  rmw_ret_t ret = RMW_RET_OK;
+  rmw_zenoh_common_cpp::MessageBufferPtr msg_bytes_ptr;
+
+  while (*taken < count && subscription_data->zn_message_queue_->try_pop(msg_bytes_ptr)) {
+    if (!deserialize_message(subscription_data, msg_bytes_ptr, message_sequence->data[*taken])) {
+      // Keep the messages that were already taken, they are out of the queue
+      RMW_SET_ERROR_MSG("could not deserialize ROS message");
+      ret = RMW_RET_ERROR;
+      break;
+    }
+    fill_message_info(subscription, msg_bytes_ptr, &message_info_sequence->data[*taken]);
+    ++*taken;
+  }
+
+  RCUTILS_LOG_DEBUG_NAMED(
+    "rmw_zenoh_common_cpp",
+    "[rmw_take_sequence] %zu messages taken: %s",
+    *taken,
+    subscription->topic_name);
+
+  message_sequence->size = *taken;
+  message_info_sequence->size = *taken;
+
+  return ret;
+}
+
 /// UNIMPLEMENTED ==============================================================
 rmw_ret_t
 rmw_init_subscription_allocation(
@@ -558,6 +630,9 @@ rmw_zenoh_common_subscription_count_matched_publishers(
     subscription->implementation_identifier,
     eclipse_zenoh_identifier,
     return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  auto subscription_data = static_cast<rmw_subscription_data_t *>(subscription->data);
+  *count = subscription_data->topic_endpoints_->publishers.load();
   return RMW_RET_OK;
 }
 
@@ -593,79 +668,263 @@ rmw_zenoh_common_subscription_get_actual_qos(
   return RMW_RET_OK;
 }
 
+/// TAKE SERIALIZED MESSAGE ====================================================
+// Take message out of the message queue, without deserializing it, and obtain its message info
+// if message_info isn't null
+//
+// The queued bytes are copied once, into the serialized message buffer (which is only resized if
+// it is too small to hold them).
+static rmw_ret_t
+take_serialized_message(
+  const rmw_subscription_t * subscription,
+  rmw_serialized_message_t * serialized_message,
+  bool * taken,
+  rmw_message_info_t * message_info,
+  const char * const eclipse_zenoh_identifier)
+{
+  // ASSERTIONS ================================================================
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(serialized_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(taken, RMW_RET_INVALID_ARGUMENT);
+  *taken = false;
+
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    eclipse_zenoh_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription->data, RMW_RET_ERROR);
+
+  // OBTAIN SUBSCRIPTION MEMBERS ===============================================
+  auto * subscription_data = static_cast<rmw_subscription_data_t *>(subscription->data);
+
+  // RETRIEVE SERIALIZED MESSAGE ===============================================
+  rmw_zenoh_common_cpp::MessageBufferPtr msg_bytes_ptr;
+
+  if (!subscription_data->zn_message_queue_->try_pop(msg_bytes_ptr)) {
+    // No message, but the check was done (see rmw_zenoh_common_take())
+    return RMW_RET_OK;
+  }
+
+  RCUTILS_LOG_DEBUG_NAMED(
+    "rmw_zenoh_common_cpp",
+    "[rmw_take_serialized_message] Message found: %s",
+    subscription->topic_name);
+
+  // COPY SERIALIZED MESSAGE ===================================================
+  const size_t data_length = message_length(msg_bytes_ptr);
+  if (serialized_message->buffer_capacity < data_length) {
+    rmw_ret_t ret = rmw_serialized_message_resize(serialized_message, data_length);
+    if (ret != RMW_RET_OK) {
+      return ret;  // Error message already set
+    }
+  }
+
+  std::memcpy(serialized_message->buffer, msg_bytes_ptr->data(), data_length);
+  serialized_message->buffer_length = data_length;
+
+  if (message_info) {
+    fill_message_info(subscription, msg_bytes_ptr, message_info);
+  }
+  *taken = true;
+
+  return RMW_RET_OK;
+}
+
 rmw_ret_t
-rmw_take_serialized_message(
+rmw_zenoh_common_take_serialized_message(
   const rmw_subscription_t * subscription,
   rmw_serialized_message_t * serialized_message,
   bool * taken,
-  rmw_subscription_allocation_t * allocation)
+  rmw_subscription_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier)
 {
-  (void)subscription;
-  (void)serialized_message;
-  (void)taken;
   (void)allocation;
   RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_take_serialized_message");
-  return RMW_RET_UNSUPPORTED;
+
+  return take_serialized_message(
+    subscription,
+    serialized_message,
+    taken,
+    nullptr,
+    eclipse_zenoh_identifier);
 }
 
+/// TAKE SERIALIZED MESSAGE WITH INFO ==========================================
+// Take message out of the message queue without deserializing it, and obtain its message info
 rmw_ret_t
-rmw_take_serialized_message_with_info(
+rmw_zenoh_common_take_serialized_message_with_info(
   const rmw_subscription_t * subscription,
   rmw_serialized_message_t * serialized_message,
   bool * taken,
   rmw_message_info_t * message_info,
-  rmw_subscription_allocation_t * allocation)
+  rmw_subscription_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier)
 {
-  (void)subscription;
-  (void)serialized_message;
-  (void)taken;
-  (void)message_info;
   (void)allocation;
-  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_take_serialized_message");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_take_serialized_message_with_info");
+
+  RMW_CHECK_ARGUMENT_FOR_NULL(message_info, RMW_RET_INVALID_ARGUMENT);
+
+  return take_serialized_message(
+    subscription,
+    serialized_message,
+    taken,
+    message_info,
+    eclipse_zenoh_identifier);
+}
+
+/// TAKE LOANED MESSAGE ========================================================
+// Take message out of the message queue, deserialized into a message lent to the user
+//
+// Loaned messages come from the subscription's loan pool, and go back to it through
+// rmw_return_loaned_message_from_subscription(). Since returned messages are recycled without being
+// destroyed, deserializing into them reuses the memory of their members (e.g. the capacity of C++
+// sequences) instead of allocating it again for every message.
+//
+// The message info is obtained too if message_info isn't null.
+static rmw_ret_t
+take_loaned_message(
+  const rmw_subscription_t * subscription,
+  void ** loaned_message,
+  bool * taken,
+  rmw_message_info_t * message_info,
+  const char * const eclipse_zenoh_identifier)
+{
+  // ASSERTIONS ================================================================
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(loaned_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(taken, RMW_RET_INVALID_ARGUMENT);
+  *taken = false;
+
+  if (*loaned_message) {
+    RMW_SET_ERROR_MSG("loaned_message must be a pointer to a null pointer");
+    return RMW_RET_INVALID_ARGUMENT;
+  }
+
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    eclipse_zenoh_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription->data, RMW_RET_ERROR);
+
+  if (!subscription->can_loan_messages) {
+    RMW_SET_ERROR_MSG("loaning is not supported for the type of this subscription");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  // OBTAIN SUBSCRIPTION MEMBERS ===============================================
+  auto * subscription_data = static_cast<rmw_subscription_data_t *>(subscription->data);
+
+  // ACQUIRE LOANED MESSAGE ====================================================
+  // Before taking the serialized message, so that it stays queued if this fails
+  void * ros_message = subscription_data->loan_pool_->acquire();
+  if (!ros_message) {
+    RMW_SET_ERROR_MSG("failed to allocate loaned message");
+    return RMW_RET_BAD_ALLOC;
+  }
+
+  // RETRIEVE SERIALIZED MESSAGE ===============================================
+  rmw_zenoh_common_cpp::MessageBufferPtr msg_bytes_ptr;
+
+  if (!subscription_data->zn_message_queue_->try_pop(msg_bytes_ptr)) {
+    // No message, but the check was done (see rmw_zenoh_common_take())
+    subscription_data->loan_pool_->release(ros_message);
+    return RMW_RET_OK;
+  }
+
+  RCUTILS_LOG_DEBUG_NAMED(
+    "rmw_zenoh_common_cpp",
+    "[rmw_take_loaned_message] Message found: %s",
+    subscription->topic_name);
+
+  // DESERIALIZE INTO LOANED MESSAGE ===========================================
+  if (!deserialize_message(subscription_data, msg_bytes_ptr, ros_message)) {
+    subscription_data->loan_pool_->release(ros_message);
+    RMW_SET_ERROR_MSG("could not deserialize ROS message");
+    return RMW_RET_ERROR;
+  }
+
+  if (message_info) {
+    fill_message_info(subscription, msg_bytes_ptr, message_info);
+  }
+  *loaned_message = ros_message;
+  *taken = true;
+
+  return RMW_RET_OK;
 }
 
 rmw_ret_t
-rmw_take_loaned_message(
+rmw_zenoh_common_take_loaned_message(
   const rmw_subscription_t * subscription,
   void ** loaned_message,
   bool * taken,
-  rmw_subscription_allocation_t * allocation)
+  rmw_subscription_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier)
 {
-  (void)subscription;
-  (void)loaned_message;
-  (void)taken;
   (void)allocation;
-  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_take_loaned_message (Unsupported)");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_take_loaned_message");
+
+  return take_loaned_message(
+    subscription,
+    loaned_message,
+    taken,
+    nullptr,
+    eclipse_zenoh_identifier);
 }
 
+/// TAKE LOANED MESSAGE WITH INFO ==============================================
+// Take a loaned message, and obtain its message info
 rmw_ret_t
 rmw_zenoh_common_take_loaned_message_with_info(
   const rmw_subscription_t * subscription,
   void ** loaned_message,
   bool * taken,
   rmw_message_info_t * message_info,
-  rmw_subscription_allocation_t * allocation)
+  rmw_subscription_allocation_t * allocation,
+  const char * const eclipse_zenoh_identifier)
 {
-  (void)subscription;
-  (void)loaned_message;
-  (void)taken;
-  (void)message_info;
   (void)allocation;
-  RCUTILS_LOG_DEBUG_NAMED(
-    "rmw_zenoh_common_cpp",
-    "rmw_take_loaned_message_with_info (Unsupported)");
-  return RMW_RET_UNSUPPORTED;
+  RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_take_loaned_message_with_info");
+
+  RMW_CHECK_ARGUMENT_FOR_NULL(message_info, RMW_RET_INVALID_ARGUMENT);
+
+  return take_loaned_message(
+    subscription,
+    loaned_message,
+    taken,
+    message_info,
+    eclipse_zenoh_identifier);
 }
 
+/// RETURN LOANED MESSAGE FROM SUBSCRIPTION ====================================
+// Take back a message lent by rmw_take_loaned_message(), to be reused for a later loan
 rmw_ret_t
 rmw_zenoh_common_return_loaned_message_from_subscription(
   const rmw_subscription_t * subscription,
-  void * loaned_message)
+  void * loaned_message,
+  const char * const eclipse_zenoh_identifier)
 {
-  (void)subscription;
-  (void)loaned_message;
   RCUTILS_LOG_DEBUG_NAMED("rmw_zenoh_common_cpp", "rmw_return_loaned_message_from_subscription");
-  return RMW_RET_UNSUPPORTED;
+
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_ARGUMENT_FOR_NULL(loaned_message, RMW_RET_INVALID_ARGUMENT);
+  RMW_CHECK_TYPE_IDENTIFIERS_MATCH(
+    subscription,
+    subscription->implementation_identifier,
+    eclipse_zenoh_identifier,
+    return RMW_RET_INCORRECT_RMW_IMPLEMENTATION);
+  RMW_CHECK_ARGUMENT_FOR_NULL(subscription->data, RMW_RET_ERROR);
+
+  if (!subscription->can_loan_messages) {
+    RMW_SET_ERROR_MSG("loaning is not supported for the type of this subscription");
+    return RMW_RET_UNSUPPORTED;
+  }
+
+  static_cast<rmw_subscription_data_t *>(subscription->data)->loan_pool_->release(loaned_message);
+
+  return RMW_RET_OK;
 }
@@ -16,6 +16,9 @@
 // This file was significantly modified from:
 // https://github.com/ros2/rmw_fastrtps/blob/47a369ea9a4b042d4ffea5e614ed84e766fdb049/rmw_fastrtps_shared_cpp/src/rmw_wait_set.cpp
 
+#include <algorithm>
+#include <chrono>
+
 #include "rcutils/logging_macros.h"
 
 #include "rmw/impl/cpp/macros.hpp"
@@ -27,6 +30,10 @@
 
 #include "rmw_zenoh_common_cpp/rmw_zenoh_common.h"
 
+// Longest a wait blocks without re-checking its conditions, when an entity couldn't take another
+// wait set (see ConditionListener::MAX_ATTACHED_WAIT_SETS) and so won't wake it up
+static constexpr std::chrono::milliseconds UNNOTIFIED_WAIT_PERIOD(500);
+
 /// CREATE WAIT SET ============================================================
 // Create and return a wait set to wait to store conditions that the middleware will block on
 rmw_wait_set_t *
@@ -174,11 +181,14 @@ rmw_wait(
     return RMW_RET_ERROR;
   }
 
-  // NOTE(CH3): We may need to pass the mutex to any callback functions used by Zenoh
+  // ATTACH CONDITIONS =========================================================
+  // The Zenoh callbacks of each entity and guard condition triggers notify the wait set, so this
+  // wait returns as soon as something arrives for it
   //
-  // Unfortunately, since all the callbacks are static, this means if we want to, we will have
-  // to create a static mutex in something like wait_impl.cpp, assign it in here, pass it in to
-  // each static callback function, and then unassign it later on.
+  // Attaching and detaching happen while the condition mutex is NOT held, since detaching waits
+  // for in-flight notifications, which may need the condition mutex
+  bool notified = attach_wait_conditions(
+    subscriptions, guard_conditions, services, clients, wait_set_info);
 
   // CHECK WAIT CONDITIONS =====================================================
   std::unique_lock<std::mutex> lock(*condition_mutex);
@@ -203,27 +213,55 @@ rmw_wait(
   bool timed_out = false;
 
   if (!ready) {
+    if (!wait_timeout || wait_timeout->sec > 0 || wait_timeout->nsec > 0) {
+      // Notifiers only take the condition mutex once this is set. The predicate is checked again
+      // before blocking, after the fence, so nothing notified in between gets missed.
+      wait_set_info->waiting.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
     if (!wait_timeout) {
-      // TODO(CH3): Remove this magic number once stable. This is to slow things down so things are
-      // visible with all the printouts flying everywhere.
-      condition_variable->wait_for(lock, std::chrono::milliseconds(500), predicate);
+      if (notified) {
+        condition_variable->wait(lock, predicate);
+      } else {
+        while (!condition_variable->wait_for(lock, UNNOTIFIED_WAIT_PERIOD, predicate)) {
+        }
+      }
     } else if (wait_timeout->sec > 0 || wait_timeout->nsec > 0) {
       auto wait_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
         std::chrono::seconds(wait_timeout->sec));
       wait_time += std::chrono::nanoseconds(wait_timeout->nsec);
 
-      timed_out = !condition_variable->wait_for(lock, wait_time, predicate);
+      if (notified) {
+        timed_out = !condition_variable->wait_for(lock, wait_time, predicate);
+      } else {
+        auto deadline = std::chrono::steady_clock::now() + wait_time;
+        timed_out = true;
+        while (timed_out && std::chrono::steady_clock::now() < deadline) {
+          auto period_end = std::chrono::steady_clock::now() + UNNOTIFIED_WAIT_PERIOD;
+          timed_out = !condition_variable->wait_until(
+            lock, std::min(period_end, deadline), predicate);
+        }
+      }
     } else {
       timed_out = true;
     }
+
+    wait_set_info->waiting.store(false, std::memory_order_relaxed);
   }
 
+  lock.unlock();
+
+  // DETACH CONDITIONS =========================================================
+  detach_wait_conditions(subscriptions, guard_conditions, services, clients, wait_set_info);
+
   // The finalize parameter passed in here enables debug and setting of non-ready conditions
   // to NULL (as expected by rcl)
   //
   // (In other words, it ensures that this happens once per rmw_wait call)
   //
   // Debug logs and NULL assignments do not happen in the predicate above, and only on this call
+  lock.lock();
   check_wait_conditions(subscriptions, guard_conditions, services, clients, events, true);
   lock.unlock();
 
@@ -0,0 +1,136 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Request throughput of a service RequestQueue as the executor threads taking requests scale
+//
+// Usage: benchmark_request_queue [requests per client]
+//
+// A client thread per lane pushes its requests (like the Zenoh callbacks would), while 1, 2, 4 and
+// 8 executor threads take them. This is timing based and depends on the machine, so it is built
+// with the tests but not run by them.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "rcutils/allocator.h"
+
+#include "impl/buffer_pool.hpp"
+#include "impl/gid.hpp"
+#include "impl/request_queue.hpp"
+
+using rmw_zenoh_common_cpp::BufferPool;
+using rmw_zenoh_common_cpp::GID_SIZE;
+using rmw_zenoh_common_cpp::MessageBufferPtr;
+using rmw_zenoh_common_cpp::RequestQueue;
+
+namespace
+{
+constexpr size_t CLIENT_COUNT = RequestQueue::LANE_COUNT;
+constexpr size_t LANE_DEPTH = 1024;
+constexpr size_t REQUEST_SIZE = 64;
+
+struct Result
+{
+  double seconds;
+  size_t taken;
+  size_t dropped;
+};
+
+Result
+run(
+  BufferPool & pool,
+  const std::vector<std::vector<uint8_t>> & clients,
+  size_t requests,
+  size_t executor_threads)
+{
+  RequestQueue queue(LANE_DEPTH);
+  std::atomic<size_t> clients_done(0);
+  std::atomic<size_t> taken(0);
+  std::atomic<size_t> dropped(0);
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<std::thread> threads;
+  for (const auto & client : clients) {
+    threads.emplace_back(
+      [&pool, &queue, &client, &clients_done, &dropped, requests]() {
+        for (size_t i = 0; i < requests; ++i) {
+          dropped.fetch_add(queue.push(pool.acquire(REQUEST_SIZE), client.data()));
+        }
+        clients_done.fetch_add(1);
+      });
+  }
+  for (size_t t = 0; t < executor_threads; ++t) {
+    threads.emplace_back(
+      [&queue, &clients, &clients_done, &taken]() {
+        MessageBufferPtr request;
+        size_t local_taken = 0;
+        while (true) {
+          if (queue.try_pop(request)) {
+            ++local_taken;
+            continue;
+          }
+          // Only stop once the clients are done and everything they pushed has been taken
+          if (clients_done.load() == clients.size() && queue.empty()) {
+            break;
+          }
+          std::this_thread::yield();
+        }
+        taken.fetch_add(local_taken);
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return Result{elapsed.count(), taken.load(), dropped.load()};
+}
+}  // namespace
+
+int
+main(int argc, char ** argv)
+{
+  size_t requests = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+
+  // One client per lane, so the executor threads take from all of them in turn
+  std::vector<std::vector<uint8_t>> clients;
+  std::vector<bool> used_lanes(RequestQueue::LANE_COUNT, false);
+  for (uint8_t id = 0; clients.size() < CLIENT_COUNT; ++id) {
+    std::vector<uint8_t> gid(GID_SIZE, 0);
+    gid[GID_SIZE - 1] = id;
+    size_t lane = RequestQueue::lane_index(gid.data());
+    if (!used_lanes[lane]) {
+      used_lanes[lane] = true;
+      clients.push_back(gid);
+    }
+  }
+
+  BufferPool pool(rcutils_get_default_allocator());
+
+  std::printf(
+    "%zu clients, %zu requests each, lane depth %zu\n", clients.size(), requests, LANE_DEPTH);
+  std::printf("%8s %14s %14s %10s\n", "threads", "taken/s", "taken", "dropped");
+  for (size_t executor_threads : {1, 2, 4, 8}) {
+    Result result = run(pool, clients, requests, executor_threads);
+    std::printf(
+      "%8zu %14.0f %14zu %10zu\n", executor_threads, result.taken / result.seconds, result.taken,
+      result.dropped);
+  }
+  return 0;
+}
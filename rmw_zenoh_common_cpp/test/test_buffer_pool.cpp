@@ -0,0 +1,157 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rcutils/allocator.h"
+
+#include "impl/buffer_pool.hpp"
+
+using rmw_zenoh_common_cpp::BufferPool;
+using rmw_zenoh_common_cpp::MessageBuffer;
+using rmw_zenoh_common_cpp::MessageBufferPtr;
+
+class TestBufferPool : public ::testing::Test
+{
+protected:
+  TestBufferPool()
+  : pool(rcutils_get_default_allocator()) {}
+
+  BufferPool pool;
+};
+
+TEST_F(TestBufferPool, acquire_sets_size_and_rounds_capacity_up) {
+  MessageBufferPtr buffer = pool.acquire(300);
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(300u, buffer->size());
+  EXPECT_EQ(512u, buffer->capacity());
+
+  // Smallest size class
+  MessageBufferPtr tiny = pool.acquire(1);
+  ASSERT_TRUE(tiny);
+  EXPECT_EQ(1u, tiny->size());
+  EXPECT_EQ(256u, tiny->capacity());
+
+  // Exactly a size class
+  MessageBufferPtr exact = pool.acquire(1024);
+  ASSERT_TRUE(exact);
+  EXPECT_EQ(1024u, exact->capacity());
+}
+
+TEST_F(TestBufferPool, released_buffer_is_reused_by_its_size_class) {
+  MessageBuffer * first = nullptr;
+  {
+    MessageBufferPtr buffer = pool.acquire(300);
+    ASSERT_TRUE(buffer);
+    first = buffer.get();
+  }
+  EXPECT_EQ(0u, pool.hits());
+  EXPECT_EQ(1u, pool.misses());
+
+  // Same size class (512 bytes), so the released buffer is handed out again
+  MessageBufferPtr again = pool.acquire(400);
+  ASSERT_TRUE(again);
+  EXPECT_EQ(first, again.get());
+  EXPECT_EQ(400u, again->size());
+  EXPECT_EQ(1u, pool.hits());
+
+  // Another size class needs another buffer
+  MessageBufferPtr other = pool.acquire(2000);
+  ASSERT_TRUE(other);
+  EXPECT_NE(first, other.get());
+  EXPECT_EQ(2048u, other->capacity());
+  EXPECT_EQ(2u, pool.misses());
+}
+
+TEST_F(TestBufferPool, buffer_is_released_with_its_last_handle) {
+  MessageBuffer * first = nullptr;
+  MessageBufferPtr copy;
+  {
+    MessageBufferPtr buffer = pool.acquire(100);
+    ASSERT_TRUE(buffer);
+    first = buffer.get();
+    copy = buffer;
+  }
+
+  // Still held by the copy, so a new buffer must be allocated
+  MessageBufferPtr second = pool.acquire(100);
+  ASSERT_TRUE(second);
+  EXPECT_NE(first, second.get());
+
+  copy.reset();
+  MessageBufferPtr third = pool.acquire(100);
+  ASSERT_TRUE(third);
+  EXPECT_EQ(first, third.get());
+}
+
+TEST_F(TestBufferPool, handle_is_unique_once_the_others_are_gone) {
+  MessageBufferPtr buffer = pool.acquire(100);
+  ASSERT_TRUE(buffer);
+  EXPECT_TRUE(buffer.unique());
+
+  std::vector<MessageBufferPtr> copies(3, buffer);
+  EXPECT_FALSE(buffer.unique());
+  EXPECT_FALSE(copies[0].unique());
+
+  copies.clear();
+  EXPECT_TRUE(buffer.unique());
+
+  buffer.reset();
+  EXPECT_FALSE(buffer.unique());
+}
+
+TEST_F(TestBufferPool, huge_buffers_are_not_pooled) {
+  const size_t huge = 8 * 1024 * 1024;
+  {
+    MessageBufferPtr buffer = pool.acquire(huge);
+    ASSERT_TRUE(buffer);
+    EXPECT_EQ(huge, buffer->size());
+    EXPECT_GE(buffer->capacity(), huge);
+  }
+  MessageBufferPtr buffer = pool.acquire(huge);
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(0u, pool.hits());
+  EXPECT_EQ(2u, pool.misses());
+}
+
+TEST_F(TestBufferPool, concurrent_acquire_and_release) {
+  constexpr int threads_count = 4;
+  constexpr int iterations = 10000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_count; ++t) {
+    threads.emplace_back(
+      [this, t]() {
+        for (int i = 0; i < iterations; ++i) {
+          MessageBufferPtr buffer = pool.acquire(64 + (i % 4) * 256);
+          ASSERT_TRUE(buffer);
+          buffer->data()[0] = static_cast<unsigned char>(t);
+          MessageBufferPtr shared = buffer;
+          buffer.reset();
+          EXPECT_EQ(static_cast<unsigned char>(t), shared->data()[0]);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(
+    static_cast<size_t>(threads_count * iterations), pool.hits() + pool.misses());
+  EXPECT_GT(pool.hits(), pool.misses());
+}
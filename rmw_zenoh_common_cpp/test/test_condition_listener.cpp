@@ -0,0 +1,108 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "impl/condition_listener.hpp"
+
+namespace
+{
+// Block on a wait set like rmw_wait() does, until flag is set or the timeout expires
+bool
+wait_for_flag(
+  rmw_wait_set_data_t & wait_set, const std::atomic_bool & flag, std::chrono::milliseconds timeout)
+{
+  std::unique_lock<std::mutex> lock(wait_set.condition_mutex);
+  wait_set.waiting.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  bool set = wait_set.condition.wait_for(lock, timeout, [&flag]() {return flag.load();});
+  wait_set.waiting.store(false, std::memory_order_relaxed);
+  return set;
+}
+}  // namespace
+
+TEST(TestConditionListener, notifies_every_attached_wait_set) {
+  ConditionListener listener;
+  rmw_wait_set_data_t first;
+  rmw_wait_set_data_t second;
+  EXPECT_TRUE(listener.attachCondition(&first));
+  EXPECT_TRUE(listener.attachCondition(&second));
+
+  std::atomic_bool flag(false);
+  std::atomic<int> woken(0);
+  std::vector<std::thread> waiters;
+  for (rmw_wait_set_data_t * wait_set : {&first, &second}) {
+    waiters.emplace_back(
+      [wait_set, &flag, &woken]() {
+        if (wait_for_flag(*wait_set, flag, std::chrono::seconds(10))) {
+          woken.fetch_add(1);
+        }
+      });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  flag.store(true);
+  listener.notify();
+  for (auto & waiter : waiters) {
+    waiter.join();
+  }
+  EXPECT_EQ(2, woken.load());
+
+  listener.detachCondition(&first);
+  listener.detachCondition(&second);
+}
+
+TEST(TestConditionListener, detaching_only_removes_its_own_wait_set) {
+  ConditionListener listener;
+  rmw_wait_set_data_t first;
+  rmw_wait_set_data_t second;
+  EXPECT_TRUE(listener.attachCondition(&first));
+  EXPECT_TRUE(listener.attachCondition(&second));
+  listener.detachCondition(&first);
+
+  // Detaching a wait set that isn't attached is a no-op
+  listener.detachCondition(&first);
+
+  std::atomic_bool flag(false);
+  std::thread waiter(
+    [&second, &flag]() {
+      EXPECT_TRUE(wait_for_flag(second, flag, std::chrono::seconds(10)));
+    });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  flag.store(true);
+  listener.notify();
+  waiter.join();
+
+  listener.detachCondition(&second);
+}
+
+TEST(TestConditionListener, attaching_too_many_wait_sets_fails) {
+  ConditionListener listener;
+  std::vector<rmw_wait_set_data_t> wait_sets(ConditionListener::MAX_ATTACHED_WAIT_SETS + 1);
+  for (size_t i = 0; i < ConditionListener::MAX_ATTACHED_WAIT_SETS; ++i) {
+    EXPECT_TRUE(listener.attachCondition(&wait_sets[i])) << i;
+  }
+  EXPECT_FALSE(listener.attachCondition(&wait_sets.back()));
+
+  // A slot is freed by detaching
+  listener.detachCondition(&wait_sets[0]);
+  EXPECT_TRUE(listener.attachCondition(&wait_sets.back()));
+}
@@ -0,0 +1,167 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "impl/graph_message.hpp"
+
+using rmw_zenoh_common_cpp::EntityInfo;
+using rmw_zenoh_common_cpp::EntityKind;
+using rmw_zenoh_common_cpp::GID_SIZE;
+using rmw_zenoh_common_cpp::GraphMessageReader;
+using rmw_zenoh_common_cpp::GraphMessageWriter;
+using rmw_zenoh_common_cpp::GraphRecord;
+
+namespace
+{
+EntityInfo
+make_entity(EntityKind kind, uint8_t id, const std::string & name, const std::string & type)
+{
+  EntityInfo entity;
+  entity.kind = kind;
+  std::memset(entity.gid, id, GID_SIZE);
+  entity.name = name;
+  entity.type = type;
+  entity.node_name = "talker";
+  entity.node_namespace = "/ns";
+  return entity;
+}
+
+bool
+read(const std::vector<uint8_t> & data, uint64_t & sequence, std::vector<GraphRecord> & records)
+{
+  return GraphMessageReader(data.data(), data.size()).read(sequence, records);
+}
+}  // namespace
+
+class TestGraphMessage : public ::testing::Test
+{
+protected:
+  TestGraphMessage()
+  : publisher(make_entity(EntityKind::PUBLISHER, 1, "/chatter", "std_msgs/msg/String")),
+    node(make_entity(EntityKind::NODE, 2, "talker", "/"))
+  {
+    std::memset(removed_gid, 3, GID_SIZE);
+
+    // Record boundaries, as the message is written
+    GraphMessageWriter writer(42);
+    boundaries.push_back(writer.data().size());
+    writer.add(publisher);
+    boundaries.push_back(writer.data().size());
+    writer.remove(removed_gid);
+    boundaries.push_back(writer.data().size());
+    writer.add(node);
+    boundaries.push_back(writer.data().size());
+    message = writer.data();
+  }
+
+  EntityInfo publisher;
+  EntityInfo node;
+  uint8_t removed_gid[GID_SIZE];
+
+  std::vector<uint8_t> message;
+  std::vector<size_t> boundaries;
+};
+
+TEST_F(TestGraphMessage, records_round_trip) {
+  uint64_t sequence = 0;
+  std::vector<GraphRecord> records;
+  ASSERT_TRUE(read(message, sequence, records));
+  EXPECT_EQ(42u, sequence);
+  ASSERT_EQ(3u, records.size());
+
+  EXPECT_TRUE(records[0].added);
+  EXPECT_EQ(EntityKind::PUBLISHER, records[0].entity.kind);
+  EXPECT_EQ(0, std::memcmp(publisher.gid, records[0].entity.gid, GID_SIZE));
+  EXPECT_EQ("/chatter", records[0].entity.name);
+  EXPECT_EQ("std_msgs/msg/String", records[0].entity.type);
+  EXPECT_EQ("talker", records[0].entity.node_name);
+  EXPECT_EQ("/ns", records[0].entity.node_namespace);
+
+  EXPECT_FALSE(records[1].added);
+  EXPECT_EQ(0, std::memcmp(removed_gid, records[1].entity.gid, GID_SIZE));
+
+  EXPECT_TRUE(records[2].added);
+  EXPECT_EQ(EntityKind::NODE, records[2].entity.kind);
+  EXPECT_EQ(0, std::memcmp(node.gid, records[2].entity.gid, GID_SIZE));
+  EXPECT_EQ("talker", records[2].entity.name);
+  EXPECT_EQ("/", records[2].entity.type);
+}
+
+TEST_F(TestGraphMessage, heartbeat_has_no_records) {
+  GraphMessageWriter writer(0x0102030405060708);
+  ASSERT_EQ(sizeof(uint64_t), writer.data().size());
+
+  // Little endian
+  EXPECT_EQ(0x08, writer.data()[0]);
+  EXPECT_EQ(0x01, writer.data()[7]);
+
+  uint64_t sequence = 0;
+  std::vector<GraphRecord> records;
+  ASSERT_TRUE(read(writer.data(), sequence, records));
+  EXPECT_EQ(0x0102030405060708u, sequence);
+  EXPECT_TRUE(records.empty());
+}
+
+TEST_F(TestGraphMessage, truncated_message_is_malformed) {
+  // Cut anywhere but between two records, the message can't be read
+  for (size_t size = 0; size < message.size(); ++size) {
+    std::vector<uint8_t> truncated(message.begin(), message.begin() + size);
+
+    uint64_t sequence = 0;
+    std::vector<GraphRecord> records;
+    bool read_ok = read(truncated, sequence, records);
+
+    size_t boundary = 0;
+    while (boundary < boundaries.size() && boundaries[boundary] < size) {
+      ++boundary;
+    }
+    if (boundary < boundaries.size() && boundaries[boundary] == size) {
+      EXPECT_TRUE(read_ok) << size;
+      EXPECT_EQ(boundary, records.size()) << size;
+    } else {
+      EXPECT_FALSE(read_ok) << size;
+    }
+  }
+}
+
+TEST_F(TestGraphMessage, unknown_entity_kind_is_malformed) {
+  // The kind follows the op of the first record
+  std::vector<uint8_t> invalid(message);
+  invalid[boundaries[0] + 1] = static_cast<uint8_t>(EntityKind::CLIENT) + 1;
+
+  uint64_t sequence = 0;
+  std::vector<GraphRecord> records;
+  EXPECT_FALSE(read(invalid, sequence, records));
+
+  invalid[boundaries[0] + 1] = static_cast<uint8_t>(EntityKind::CLIENT);
+  records.clear();
+  EXPECT_TRUE(read(invalid, sequence, records));
+  EXPECT_EQ(EntityKind::CLIENT, records[0].entity.kind);
+}
+
+TEST_F(TestGraphMessage, oversized_string_length_is_malformed) {
+  // The length of the name of the first record, past the op, kind and GID
+  std::vector<uint8_t> invalid(message);
+  invalid[boundaries[0] + 2 + GID_SIZE + 3] = 0xFF;
+
+  uint64_t sequence = 0;
+  std::vector<GraphRecord> records;
+  EXPECT_FALSE(read(invalid, sequence, records));
+}
@@ -0,0 +1,289 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rcutils/allocator.h"
+
+#include "impl/buffer_pool.hpp"
+#include "impl/gid.hpp"
+#include "impl/message_batch.hpp"
+
+using rmw_zenoh_common_cpp::BatchFlusher;
+using rmw_zenoh_common_cpp::BufferPool;
+using rmw_zenoh_common_cpp::MessageBatch;
+using rmw_zenoh_common_cpp::PUBLISHER_GID_TRAILER_SIZE;
+
+/// ZENOH STAND-IN =============================================================
+// The batches are given a null session, and their samples are recorded here instead of written
+// (locked, as a BatchFlusher writes them from its own thread)
+namespace
+{
+std::mutex written_samples_mutex;
+std::vector<std::string> written_samples;
+bool fail_writes = false;
+}  // namespace
+
+extern "C"
+{
+zn_reskey_t
+zn_rid(z_zint_t id)
+{
+  zn_reskey_t reskey;
+  reskey.id = id;
+  reskey.suffix = nullptr;
+  return reskey;
+}
+
+int
+zn_write(zn_session_t * session, zn_reskey_t reskey, const char * payload, unsigned int len)
+{
+  (void)session;
+  (void)reskey;
+  std::lock_guard<std::mutex> guard(written_samples_mutex);
+  if (fail_writes) {
+    return 1;
+  }
+  written_samples.emplace_back(payload, len);
+  return 0;
+}
+}
+
+class TestMessageBatch : public ::testing::Test
+{
+protected:
+  static constexpr size_t kMaxFrameSize = 64;
+
+  TestMessageBatch()
+  : pool(rcutils_get_default_allocator()),
+    batch(pool, nullptr, 1, gid, kMaxFrameSize)
+  {
+    for (size_t i = 0; i < rmw_zenoh_common_cpp::GID_SIZE; ++i) {
+      gid[i] = static_cast<uint8_t>(0xA0 + i);
+    }
+  }
+
+  void SetUp() override
+  {
+    written_samples.clear();
+    fail_writes = false;
+  }
+
+  // Add a message to the batch, from a buffer with room for the publisher GID like publishers have
+  bool
+  add(const std::string & message)
+  {
+    std::vector<uint8_t> data(message.begin(), message.end());
+    data.resize(message.size() + PUBLISHER_GID_TRAILER_SIZE);
+    return batch.add(data.data(), message.size());
+  }
+
+  // Wait until count samples were written, or the timeout expires
+  bool
+  wait_for_written_samples(size_t count, std::chrono::milliseconds timeout)
+  {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+      {
+        std::lock_guard<std::mutex> guard(written_samples_mutex);
+        if (written_samples.size() >= count) {
+          return true;
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+  }
+
+  // Check that a sample ends with the publisher GID, and return what comes before it
+  std::string
+  strip_gid(const std::string & sample)
+  {
+    EXPECT_GE(sample.size(), PUBLISHER_GID_TRAILER_SIZE);
+    std::string trailer = sample.substr(sample.size() - PUBLISHER_GID_TRAILER_SIZE);
+    EXPECT_EQ(0, std::memcmp(trailer.data(), gid, PUBLISHER_GID_TRAILER_SIZE));
+    return sample.substr(0, sample.size() - PUBLISHER_GID_TRAILER_SIZE);
+  }
+
+  // Split a (stripped) sample into its messages
+  std::vector<std::string>
+  split(const std::string & sample, bool * well_formed = nullptr)
+  {
+    std::vector<std::string> messages;
+    const uint8_t * data = reinterpret_cast<const uint8_t *>(sample.data());
+    if (!rmw_zenoh_common_cpp::is_batch_frame(data, sample.size())) {
+      messages.push_back(sample);
+      return messages;
+    }
+    bool result = rmw_zenoh_common_cpp::for_each_batched_message(
+      data, sample.size(),
+      [&messages](const uint8_t * message, size_t size) {
+        messages.emplace_back(reinterpret_cast<const char *>(message), size);
+      });
+    if (well_formed) {
+      *well_formed = result;
+    }
+    return messages;
+  }
+
+  uint8_t gid[rmw_zenoh_common_cpp::GID_SIZE];
+  BufferPool pool;
+  MessageBatch batch;
+};
+
+constexpr size_t TestMessageBatch::kMaxFrameSize;
+
+// Serialized messages start with a 0 byte (the CDR encapsulation header), like these
+const std::string kFirst("\0first", 6);
+const std::string kSecond("\0second", 7);
+const std::string kThird("\0third", 6);
+
+TEST_F(TestMessageBatch, frame_round_trip) {
+  EXPECT_TRUE(add(kFirst));
+  EXPECT_TRUE(add(kSecond));
+  EXPECT_TRUE(add(kThird));
+  EXPECT_TRUE(written_samples.empty());
+
+  EXPECT_TRUE(batch.flush());
+  ASSERT_EQ(1u, written_samples.size());
+
+  std::string frame = strip_gid(written_samples[0]);
+  EXPECT_TRUE(
+    rmw_zenoh_common_cpp::is_batch_frame(
+      reinterpret_cast<const uint8_t *>(frame.data()), frame.size()));
+
+  bool well_formed = false;
+  std::vector<std::string> messages = split(frame, &well_formed);
+  EXPECT_TRUE(well_formed);
+  EXPECT_EQ((std::vector<std::string>{kFirst, kSecond, kThird}), messages);
+
+  // Nothing left to write
+  EXPECT_TRUE(batch.flush());
+  EXPECT_EQ(1u, written_samples.size());
+}
+
+TEST_F(TestMessageBatch, lone_message_is_not_framed) {
+  EXPECT_TRUE(add(kFirst));
+  EXPECT_TRUE(batch.flush());
+
+  ASSERT_EQ(1u, written_samples.size());
+  EXPECT_EQ(kFirst, strip_gid(written_samples[0]));
+}
+
+TEST_F(TestMessageBatch, full_frame_is_written_before_the_next_message) {
+  // Each entry takes 4 + 20 bytes, so the 64 byte frame (with its 4 byte header) fits two
+  const std::string message = std::string(1, '\0') + std::string(19, 'x');
+  EXPECT_TRUE(add(message));
+  EXPECT_TRUE(add(message));
+  EXPECT_TRUE(written_samples.empty());
+
+  EXPECT_TRUE(add(message));
+  ASSERT_EQ(1u, written_samples.size());
+  EXPECT_EQ(2u, split(strip_gid(written_samples[0])).size());
+
+  EXPECT_TRUE(batch.flush());
+  ASSERT_EQ(2u, written_samples.size());
+  EXPECT_EQ(message, strip_gid(written_samples[1]));
+}
+
+TEST_F(TestMessageBatch, oversize_message_is_written_after_the_pending_frame) {
+  const std::string big = std::string(1, '\0') + std::string(kMaxFrameSize, 'x');
+
+  EXPECT_TRUE(add(kFirst));
+  EXPECT_TRUE(add(big));
+
+  // Ordering is kept: the pending message goes first, then the big one on its own
+  ASSERT_EQ(2u, written_samples.size());
+  EXPECT_EQ(kFirst, strip_gid(written_samples[0]));
+  EXPECT_EQ(big, strip_gid(written_samples[1]));
+}
+
+TEST_F(TestMessageBatch, failed_flush_of_pending_frame_does_not_fail_the_next_message) {
+  const std::string message = std::string(1, '\0') + std::string(19, 'x');
+  EXPECT_TRUE(add(message));
+  EXPECT_TRUE(add(message));
+
+  // The pending frame can't be written, but the new message is still queued
+  fail_writes = true;
+  EXPECT_TRUE(add(message));
+  EXPECT_TRUE(written_samples.empty());
+
+  fail_writes = false;
+  EXPECT_TRUE(batch.flush());
+  ASSERT_EQ(1u, written_samples.size());
+  EXPECT_EQ(message, strip_gid(written_samples[0]));
+
+  // A message that is written right away reports its own failure
+  fail_writes = true;
+  EXPECT_FALSE(add(std::string(1, '\0') + std::string(kMaxFrameSize, 'x')));
+}
+
+TEST_F(TestMessageBatch, truncated_frame_is_malformed) {
+  EXPECT_TRUE(add(kFirst));
+  EXPECT_TRUE(add(kSecond));
+  EXPECT_TRUE(batch.flush());
+  ASSERT_EQ(1u, written_samples.size());
+  const std::string frame = strip_gid(written_samples[0]);
+
+  // Only the messages before the cut are seen
+  const size_t second_entry_end = frame.size();
+  const size_t first_entry_end = second_entry_end - 4 - kSecond.size();
+  for (size_t size = rmw_zenoh_common_cpp::BATCH_FRAME_HEADER_SIZE; size < frame.size(); ++size) {
+    bool well_formed = true;
+    std::vector<std::string> messages = split(frame.substr(0, size), &well_formed);
+    if (size == rmw_zenoh_common_cpp::BATCH_FRAME_HEADER_SIZE || size == first_entry_end) {
+      EXPECT_TRUE(well_formed) << size;
+    } else {
+      EXPECT_FALSE(well_formed) << size;
+    }
+    EXPECT_EQ(size >= first_entry_end ? 1u : 0u, messages.size()) << size;
+  }
+}
+
+TEST_F(TestMessageBatch, flusher_writes_each_message_added_to_an_empty_frame) {
+  BatchFlusher flusher(std::chrono::milliseconds(10));
+  flusher.add(&batch);
+
+  // Each message wakes up the flusher again, since the frame was emptied by the previous flush
+  EXPECT_TRUE(add(kFirst));
+  EXPECT_TRUE(wait_for_written_samples(1, std::chrono::milliseconds(10000)));
+  EXPECT_TRUE(add(kSecond));
+  EXPECT_TRUE(wait_for_written_samples(2, std::chrono::milliseconds(10000)));
+
+  flusher.remove(&batch);
+  flusher.stop();
+
+  ASSERT_EQ(2u, written_samples.size());
+  EXPECT_EQ(kFirst, strip_gid(written_samples[0]));
+  EXPECT_EQ(kSecond, strip_gid(written_samples[1]));
+}
+
+TEST_F(TestMessageBatch, stopped_flusher_writes_the_pending_frames) {
+  BatchFlusher flusher(std::chrono::seconds(3600));
+  flusher.add(&batch);
+
+  EXPECT_TRUE(add(kFirst));
+  flusher.stop();
+  flusher.remove(&batch);
+
+  ASSERT_EQ(1u, written_samples.size());
+  EXPECT_EQ(kFirst, strip_gid(written_samples[0]));
+}
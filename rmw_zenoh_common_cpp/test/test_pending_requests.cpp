@@ -0,0 +1,97 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "impl/pending_requests.hpp"
+
+using rmw_zenoh_common_cpp::PendingRequests;
+
+TEST(TestPendingRequests, request_completes_once) {
+  PendingRequests pending;
+  pending.add(0);
+  pending.add(1);
+  pending.add(2);
+
+  // In any order
+  EXPECT_TRUE(pending.complete(1));
+  EXPECT_FALSE(pending.complete(1));
+  EXPECT_TRUE(pending.complete(0));
+  EXPECT_TRUE(pending.complete(2));
+  EXPECT_FALSE(pending.complete(0));
+}
+
+TEST(TestPendingRequests, unknown_request_does_not_complete) {
+  PendingRequests pending;
+  EXPECT_FALSE(pending.complete(0));
+
+  pending.add(1);
+  EXPECT_FALSE(pending.complete(0));
+  EXPECT_FALSE(pending.complete(2));
+  EXPECT_TRUE(pending.complete(1));
+}
+
+TEST(TestPendingRequests, oldest_requests_are_forgotten_beyond_the_bound) {
+  const int64_t bound = static_cast<int64_t>(PendingRequests::MAX_PENDING_REQUESTS);
+
+  PendingRequests pending;
+  for (int64_t i = 0; i <= bound; ++i) {
+    pending.add(i);
+  }
+
+  // Only the first request is over the bound
+  EXPECT_FALSE(pending.complete(0));
+  for (int64_t i = 1; i <= bound; ++i) {
+    EXPECT_TRUE(pending.complete(i)) << i;
+  }
+}
+
+TEST(TestPendingRequests, completed_requests_do_not_count_towards_the_bound) {
+  const int64_t bound = static_cast<int64_t>(PendingRequests::MAX_PENDING_REQUESTS);
+
+  // A slow request, followed by many more than the bound that complete quickly
+  PendingRequests pending;
+  pending.add(0);
+  for (int64_t i = 1; i <= 4 * bound; ++i) {
+    pending.add(i);
+    EXPECT_TRUE(pending.complete(i)) << i;
+  }
+
+  EXPECT_TRUE(pending.complete(0));
+}
+
+TEST(TestPendingRequests, requests_expire_after_the_timeout) {
+  PendingRequests pending;
+  pending.set_timeout(std::chrono::milliseconds(10));
+
+  pending.add(0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  pending.add(1);
+
+  EXPECT_FALSE(pending.complete(0));
+  EXPECT_TRUE(pending.complete(1));
+}
+
+TEST(TestPendingRequests, zero_timeout_never_expires) {
+  PendingRequests pending;
+  pending.set_timeout(std::chrono::milliseconds(0));
+
+  pending.add(0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_TRUE(pending.complete(0));
+}
@@ -0,0 +1,219 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "rcutils/allocator.h"
+
+#include "impl/buffer_pool.hpp"
+#include "impl/gid.hpp"
+#include "impl/request_queue.hpp"
+
+using rmw_zenoh_common_cpp::BufferPool;
+using rmw_zenoh_common_cpp::GID_SIZE;
+using rmw_zenoh_common_cpp::MessageBufferPtr;
+using rmw_zenoh_common_cpp::RequestQueue;
+
+class TestRequestQueue : public ::testing::Test
+{
+protected:
+  struct ClientGid
+  {
+    uint8_t data[GID_SIZE];
+  };
+
+  TestRequestQueue()
+  : pool(rcutils_get_default_allocator()) {}
+
+  // GIDs of clients whose requests all go to different lanes
+  std::vector<ClientGid>
+  clients_on_distinct_lanes(size_t count)
+  {
+    std::vector<ClientGid> clients;
+    std::vector<bool> used_lanes(RequestQueue::LANE_COUNT, false);
+    for (uint8_t id = 0; clients.size() < count; ++id) {
+      ClientGid client;
+      std::memset(client.data, 0, GID_SIZE);
+      client.data[GID_SIZE - 1] = id;
+
+      size_t lane = RequestQueue::lane_index(client.data);
+      if (!used_lanes[lane]) {
+        used_lanes[lane] = true;
+        clients.push_back(client);
+      }
+    }
+    return clients;
+  }
+
+  MessageBufferPtr
+  make_request(int id)
+  {
+    MessageBufferPtr request = pool.acquire(sizeof(id));
+    std::memcpy(request->data(), &id, sizeof(id));
+    return request;
+  }
+
+  int
+  request_id(const MessageBufferPtr & request)
+  {
+    int id;
+    std::memcpy(&id, request->data(), sizeof(id));
+    return id;
+  }
+
+  BufferPool pool;
+};
+
+TEST_F(TestRequestQueue, empty) {
+  RequestQueue queue(4);
+  EXPECT_TRUE(queue.empty());
+
+  MessageBufferPtr request;
+  EXPECT_FALSE(queue.try_pop(request));
+
+  auto clients = clients_on_distinct_lanes(1);
+  EXPECT_EQ(0u, queue.push(make_request(1), clients[0].data));
+  EXPECT_FALSE(queue.empty());
+
+  ASSERT_TRUE(queue.try_pop(request));
+  EXPECT_EQ(1, request_id(request));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(TestRequestQueue, flooding_client_only_drops_its_own_requests) {
+  constexpr size_t depth = 4;
+  RequestQueue queue(depth);
+  auto clients = clients_on_distinct_lanes(2);
+
+  EXPECT_EQ(0u, queue.push(make_request(1000), clients[1].data));
+
+  // Once its lane is full, each request of the flooding client drops its oldest one
+  for (int i = 0; i < 100; ++i) {
+    size_t dropped = queue.push(make_request(i), clients[0].data);
+    EXPECT_EQ(i < static_cast<int>(depth) ? 0u : 1u, dropped) << i;
+  }
+
+  // The other client's request is still there, and the flooding client has its newest ones
+  std::vector<int> popped;
+  MessageBufferPtr request;
+  while (queue.try_pop(request)) {
+    popped.push_back(request_id(request));
+  }
+  ASSERT_EQ(depth + 1, popped.size());
+  EXPECT_NE(popped.end(), std::find(popped.begin(), popped.end(), 1000));
+  for (int i = 100 - static_cast<int>(depth); i < 100; ++i) {
+    EXPECT_NE(popped.end(), std::find(popped.begin(), popped.end(), i)) << i;
+  }
+}
+
+TEST_F(TestRequestQueue, flooding_client_does_not_starve_the_others) {
+  RequestQueue queue(64);
+  auto clients = clients_on_distinct_lanes(3);
+
+  for (int i = 0; i < 64; ++i) {
+    queue.push(make_request(i), clients[0].data);
+  }
+  queue.push(make_request(1000), clients[1].data);
+  queue.push(make_request(2000), clients[2].data);
+
+  // Both other requests are taken within one turn of the three busy lanes, not after the flood
+  std::vector<int> popped;
+  MessageBufferPtr request;
+  for (int i = 0; i < 3 && queue.try_pop(request); ++i) {
+    popped.push_back(request_id(request));
+  }
+  EXPECT_NE(popped.end(), std::find(popped.begin(), popped.end(), 1000));
+  EXPECT_NE(popped.end(), std::find(popped.begin(), popped.end(), 2000));
+}
+
+TEST_F(TestRequestQueue, busy_lanes_are_taken_from_in_turn) {
+  RequestQueue queue(8);
+  auto clients = clients_on_distinct_lanes(2);
+
+  for (int i = 0; i < 8; ++i) {
+    queue.push(make_request(i), clients[0].data);
+    queue.push(make_request(100 + i), clients[1].data);
+  }
+
+  // Each client's requests stay in order, and the clients alternate
+  int next[2] = {0, 100};
+  int last_client = -1;
+  MessageBufferPtr request;
+  while (queue.try_pop(request)) {
+    int id = request_id(request);
+    int client = id < 100 ? 0 : 1;
+    EXPECT_EQ(next[client]++, id);
+    EXPECT_NE(last_client, client);
+    last_client = client;
+  }
+  EXPECT_EQ(8, next[0]);
+  EXPECT_EQ(108, next[1]);
+}
+
+TEST_F(TestRequestQueue, concurrent_push_and_try_pop) {
+  constexpr int producers = 4;
+  constexpr int consumers = 4;
+  constexpr int requests_per_producer = 5000;
+  constexpr int total = producers * requests_per_producer;
+
+  // Deep enough that nothing is dropped, even if all the clients shared a lane
+  RequestQueue queue(total);
+  auto clients = clients_on_distinct_lanes(producers);
+
+  std::vector<std::atomic<int>> popped(total);
+  for (auto & count : popped) {
+    count.store(0);
+  }
+  std::atomic<int> popped_total(0);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back(
+      [this, &queue, &clients, p]() {
+        for (int i = 0; i < requests_per_producer; ++i) {
+          EXPECT_EQ(
+            0u, queue.push(make_request(p * requests_per_producer + i), clients[p].data));
+        }
+      });
+  }
+  for (int c = 0; c < consumers; ++c) {
+    threads.emplace_back(
+      [this, &queue, &popped, &popped_total]() {
+        MessageBufferPtr request;
+        while (popped_total.load() < total) {
+          if (queue.try_pop(request)) {
+            popped[request_id(request)].fetch_add(1);
+            popped_total.fetch_add(1);
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  // Every request was taken exactly once
+  for (const auto & count : popped) {
+    EXPECT_EQ(1, count.load());
+  }
+  EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,167 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "impl/ring_buffer.hpp"
+
+using rmw_zenoh_common_cpp::RingBuffer;
+
+TEST(TestRingBuffer, zero_capacity_holds_one_value) {
+  RingBuffer<int> ring(0);
+  EXPECT_EQ(1u, ring.capacity());
+
+  // A single cell ring must still tell a full cell from a free one
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(ring.try_push(int(i)));
+    EXPECT_FALSE(ring.try_push(-1));
+
+    int value = -1;
+    EXPECT_TRUE(ring.try_pop(value));
+    EXPECT_EQ(i, value);
+    EXPECT_FALSE(ring.try_pop(value));
+  }
+}
+
+TEST(TestRingBuffer, empty) {
+  RingBuffer<int> ring(4);
+  EXPECT_TRUE(ring.empty());
+
+  int value = -1;
+  EXPECT_FALSE(ring.try_pop(value));
+  EXPECT_EQ(-1, value);
+
+  EXPECT_TRUE(ring.try_push(1));
+  EXPECT_FALSE(ring.empty());
+  EXPECT_TRUE(ring.try_pop(value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(ring.empty());
+  EXPECT_FALSE(ring.try_pop(value));
+}
+
+TEST(TestRingBuffer, full_push_leaves_value_untouched) {
+  RingBuffer<std::unique_ptr<int>> ring(2);
+  EXPECT_TRUE(ring.try_push(std::unique_ptr<int>(new int(1))));
+  EXPECT_TRUE(ring.try_push(std::unique_ptr<int>(new int(2))));
+
+  std::unique_ptr<int> rejected(new int(3));
+  EXPECT_FALSE(ring.try_push(std::move(rejected)));
+  ASSERT_TRUE(rejected);
+  EXPECT_EQ(3, *rejected);
+
+  std::unique_ptr<int> value;
+  EXPECT_TRUE(ring.try_pop(value));
+  EXPECT_EQ(1, *value);
+  EXPECT_TRUE(ring.try_push(std::move(rejected)));
+}
+
+TEST(TestRingBuffer, wraparound_keeps_order) {
+  constexpr int capacity = 3;
+  RingBuffer<int> ring(capacity);
+
+  // Fill and drain the ring over many laps, so the positions wrap around the cells many times
+  int next_push = 0;
+  int next_pop = 0;
+  for (int lap = 0; lap < 100; ++lap) {
+    while (ring.try_push(int(next_push))) {
+      ++next_push;
+    }
+    EXPECT_EQ(capacity, next_push - next_pop);
+    EXPECT_FALSE(ring.empty());
+
+    int value;
+    while (ring.try_pop(value)) {
+      EXPECT_EQ(next_pop, value);
+      ++next_pop;
+    }
+    EXPECT_EQ(next_push, next_pop);
+    EXPECT_TRUE(ring.empty());
+  }
+
+  // Interleaved, with the ring never full nor empty
+  EXPECT_TRUE(ring.try_push(int(next_push++)));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(ring.try_push(int(next_push++)));
+    int value;
+    EXPECT_TRUE(ring.try_pop(value));
+    EXPECT_EQ(next_pop++, value);
+  }
+}
+
+TEST(TestRingBuffer, popped_cells_release_their_value) {
+  RingBuffer<std::shared_ptr<int>> ring(2);
+  auto shared = std::make_shared<int>(1);
+
+  EXPECT_TRUE(ring.try_push(std::shared_ptr<int>(shared)));
+  EXPECT_EQ(2, shared.use_count());
+
+  std::shared_ptr<int> value;
+  EXPECT_TRUE(ring.try_pop(value));
+  value.reset();
+  EXPECT_EQ(1, shared.use_count());
+}
+
+TEST(TestRingBuffer, concurrent_producers_and_consumers) {
+  constexpr int producers = 4;
+  constexpr int consumers = 4;
+  constexpr int values_per_producer = 20000;
+
+  RingBuffer<int> ring(16);
+  std::vector<std::atomic<int>> popped(producers * values_per_producer);
+  for (auto & count : popped) {
+    count.store(0);
+  }
+  std::atomic<int> popped_total(0);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back(
+      [&ring, p]() {
+        for (int i = 0; i < values_per_producer; ++i) {
+          int value = p * values_per_producer + i;
+          while (!ring.try_push(std::move(value))) {
+            std::this_thread::yield();
+          }
+        }
+      });
+  }
+  for (int c = 0; c < consumers; ++c) {
+    threads.emplace_back(
+      [&ring, &popped, &popped_total]() {
+        while (popped_total.load() < producers * values_per_producer) {
+          int value;
+          if (ring.try_pop(value)) {
+            popped[value].fetch_add(1);
+            popped_total.fetch_add(1);
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  // Every value was popped exactly once
+  for (const auto & count : popped) {
+    EXPECT_EQ(1, count.load());
+  }
+  EXPECT_TRUE(ring.empty());
+}
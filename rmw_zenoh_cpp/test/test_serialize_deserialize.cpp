@@ -116,3 +116,37 @@ TEST_F(CLASSNAME(TestSerializeDeserialize, RMW_IMPLEMENTATION), clean_round_trip
   EXPECT_EQ(RMW_RET_OK, rmw_serialized_message_fini(&serialized_message)) <<
     rmw_get_error_string().str;
 }
+
+TEST_F(CLASSNAME(TestSerializeDeserialize, RMW_IMPLEMENTATION), serialize_reuses_buffer) {
+  const rosidl_message_type_support_t * ts{
+    ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, BasicTypes)};
+  test_msgs__msg__BasicTypes input_message{};
+  ASSERT_TRUE(test_msgs__msg__BasicTypes__init(&input_message));
+  rcutils_allocator_t default_allocator = rcutils_get_default_allocator();
+  rmw_serialized_message_t serialized_message = rmw_get_zero_initialized_serialized_message();
+  ASSERT_EQ(
+    RMW_RET_OK, rmw_serialized_message_init(
+      &serialized_message, 0lu, &default_allocator)) << rmw_get_error_string().str;
+
+  ASSERT_EQ(RMW_RET_OK, rmw_serialize(&input_message, ts, &serialized_message)) <<
+    rmw_get_error_string().str;
+  const uint8_t * buffer = serialized_message.buffer;
+  const size_t buffer_capacity = serialized_message.buffer_capacity;
+  const size_t buffer_length = serialized_message.buffer_length;
+
+  // Serializing again into a big enough buffer shouldn't reallocate it
+  input_message.uint32_value = input_message.uint32_value + 1000000;
+  ASSERT_EQ(RMW_RET_OK, rmw_serialize(&input_message, ts, &serialized_message)) <<
+    rmw_get_error_string().str;
+  EXPECT_EQ(buffer, serialized_message.buffer);
+  EXPECT_EQ(buffer_capacity, serialized_message.buffer_capacity);
+  EXPECT_EQ(buffer_length, serialized_message.buffer_length);
+
+  size_t size = 0lu;
+  EXPECT_EQ(RMW_RET_OK, rmw_get_serialized_message_size(ts, nullptr, &size)) <<
+    rmw_get_error_string().str;
+  EXPECT_GE(size, serialized_message.buffer_length);
+
+  EXPECT_EQ(RMW_RET_OK, rmw_serialized_message_fini(&serialized_message)) <<
+    rmw_get_error_string().str;
+}
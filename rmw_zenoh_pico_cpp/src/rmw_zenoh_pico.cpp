@@ -116,8 +116,17 @@ rmw_init(const rmw_init_options_t * options, rmw_context_t * context)
       context_impl->is_shutdown = false;
     }
 
-    // CLEANUP IF PASSED =========================================================
+    // SET UP CONTEXT MEMBERS ====================================================
     context->impl = context_impl;
+
+    ret = rmw_zenoh_common_init_post(context, eclipse_zenoh_identifier);
+    if (ret != RMW_RET_OK) {
+      zn_close(session);
+      allocator->deallocate(context_impl, allocator->state);
+      return ret;
+    }
+
+    // CLEANUP IF PASSED =========================================================
     clean_when_fail.release();
 
     configure_session(context_impl->session);
@@ -332,6 +341,56 @@ rmw_publish(
     eclipse_zenoh_identifier);
 }
 
+rmw_ret_t
+rmw_publish_serialized_message(
+  const rmw_publisher_t * publisher,
+  const rmw_serialized_message_t * serialized_message,
+  rmw_publisher_allocation_t * allocation)
+{
+  return rmw_zenoh_common_publish_serialized_message(
+    publisher,
+    serialized_message,
+    allocation,
+    eclipse_zenoh_identifier);
+}
+
+rmw_ret_t
+rmw_publish_loaned_message(
+  const rmw_publisher_t * publisher,
+  void * ros_message,
+  rmw_publisher_allocation_t * allocation)
+{
+  return rmw_zenoh_common_publish_loaned_message(
+    publisher,
+    ros_message,
+    allocation,
+    eclipse_zenoh_identifier);
+}
+
+rmw_ret_t
+rmw_borrow_loaned_message(
+  const rmw_publisher_t * publisher,
+  const rosidl_message_type_support_t * type_support,
+  void ** ros_message)
+{
+  return rmw_zenoh_common_borrow_loaned_message(
+    publisher,
+    type_support,
+    ros_message,
+    eclipse_zenoh_identifier);
+}
+
+rmw_ret_t
+rmw_return_loaned_message_from_publisher(
+  const rmw_publisher_t * publisher,
+  void * loaned_message)
+{
+  return rmw_zenoh_common_return_loaned_message_from_publisher(
+    publisher,
+    loaned_message,
+    eclipse_zenoh_identifier);
+}
+
 rmw_ret_t
 rmw_take(
   const rmw_subscription_t * subscription,
@@ -377,6 +436,72 @@ rmw_take_with_info(
     eclipse_zenoh_identifier);
 }
 
+rmw_ret_t
+rmw_take_sequence(
+  const rmw_subscription_t * subscription,
+  size_t count,
+  rmw_message_sequence_t * message_sequence,
+  rmw_message_info_sequence_t * message_info_sequence,
+  size_t * taken,
+  rmw_subscription_allocation_t * allocation)
+{
+  return rmw_zenoh_common_take_sequence(
+    subscription,
+    count,
+    message_sequence,
+    message_info_sequence,
+    taken,
+    allocation,
+    eclipse_zenoh_identifier);
+}
+
+rmw_ret_t
+rmw_take_serialized_message(
+  const rmw_subscription_t * subscription,
+  rmw_serialized_message_t * serialized_message,
+  bool * taken,
+  rmw_subscription_allocation_t * allocation)
+{
+  return rmw_zenoh_common_take_serialized_message(
+    subscription,
+    serialized_message,
+    taken,
+    allocation,
+    eclipse_zenoh_identifier);
+}
+
+rmw_ret_t
+rmw_take_serialized_message_with_info(
+  const rmw_subscription_t * subscription,
+  rmw_serialized_message_t * serialized_message,
+  bool * taken,
+  rmw_message_info_t * message_info,
+  rmw_subscription_allocation_t * allocation)
+{
+  return rmw_zenoh_common_take_serialized_message_with_info(
+    subscription,
+    serialized_message,
+    taken,
+    message_info,
+    allocation,
+    eclipse_zenoh_identifier);
+}
+
+rmw_ret_t
+rmw_take_loaned_message(
+  const rmw_subscription_t * subscription,
+  void ** loaned_message,
+  bool * taken,
+  rmw_subscription_allocation_t * allocation)
+{
+  return rmw_zenoh_common_take_loaned_message(
+    subscription,
+    loaned_message,
+    taken,
+    allocation,
+    eclipse_zenoh_identifier);
+}
+
 rmw_ret_t
 rmw_take_loaned_message_with_info(
   const rmw_subscription_t * subscription,
@@ -390,7 +515,8 @@ rmw_take_loaned_message_with_info(
     loaned_message,
     taken,
     message_info,
-    allocation);
+    allocation,
+    eclipse_zenoh_identifier);
 }
 
 rmw_client_t *
@@ -447,6 +573,19 @@ rmw_get_gid_for_publisher(
     eclipse_zenoh_identifier);
 }
 
+rmw_ret_t
+rmw_compare_gids_equal(
+  const rmw_gid_t * gid1,
+  const rmw_gid_t * gid2,
+  bool * result)
+{
+  return rmw_zenoh_common_compare_gids_equal(
+    gid1,
+    gid2,
+    result,
+    eclipse_zenoh_identifier);
+}
+
 rmw_ret_t
 rmw_destroy_wait_set(
   rmw_wait_set_t * wait_set)
@@ -570,5 +709,6 @@ rmw_return_loaned_message_from_subscription(
 {
   return rmw_zenoh_common_return_loaned_message_from_subscription(
     subscription,
-    loaned_message);
+    loaned_message,
+    eclipse_zenoh_identifier);
 }